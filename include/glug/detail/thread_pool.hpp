@@ -0,0 +1,59 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace glug::detail {
+
+/**
+ * Fixed-size pool of worker threads with work stealing.
+ *
+ * Tasks submitted from a worker go to the back of its own queue and are popped
+ * from the back, keeping depth-first locality. Idle workers steal from the
+ * front of other queues, taking the oldest and usually largest pieces of work.
+ * Tasks submitted from other threads go to a shared queue.
+ *
+ * Destructor stops the workers as soon as they finish their current task,
+ * dropping any tasks still queued.
+ */
+class thread_pool {
+    public:
+    using task = std::function<void()>;
+
+    explicit thread_pool(std::size_t threads);
+    thread_pool(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+    ~thread_pool();
+
+    [[nodiscard]] std::size_t size() const noexcept { return workers.size(); }
+
+    void submit(task work);
+
+    private:
+    struct queue {
+        std::mutex mutex{};
+        std::deque<task> tasks{};
+    };
+
+    [[nodiscard]] bool try_pop(std::size_t index, task& work);
+    void run(std::size_t index);
+
+    // `shared` doubles as the sleep queue, guarding `pending` and `stopping`
+    queue shared{};
+    std::vector<std::unique_ptr<queue>> locals{};
+    std::condition_variable wakeup{};
+    std::size_t pending{};
+    bool stopping{};
+    std::vector<std::thread> workers{};
+};
+
+}  // namespace glug::detail
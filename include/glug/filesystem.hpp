@@ -1,16 +1,173 @@
 // Provided as part of glug under MIT license, (c) 2025-2026 Dominik Kaszewski
 #pragma once
 
+#include "glug/filesystem/directory.hpp"
 #include "glug/filter.hpp"
 
+#include <compare>
 #include <cstddef>
-#include <deque>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace glug::filesystem {
 
+/**
+ * File found by explorer.
+ *
+ * Interface roughly matches `std::filesystem::directory_entry`, but the type
+ * is taken from the directory listing, so querying it never accesses
+ * the filesystem. The same goes for size and last write time, if requested
+ * with `explorer_options::metadata`.
+ */
+class entry {
+    public:
+    entry() noexcept = default;
+    entry(std::filesystem::path path, std::filesystem::file_type type) :
+        path_value{ std::move(path) },
+        type_value{ type } {}
+    entry(std::filesystem::path path, const raw_status& status) :
+        path_value{ std::move(path) },
+        type_value{ status.type },
+        size_value{ status.size },
+        time_value{ status.last_write_time },
+        has_status{ true } {}
+
+    [[nodiscard]] const std::filesystem::path& path() const noexcept {
+        return path_value;
+    }
+    // NOLINTNEXTLINE(google-explicit-constructor): Same as `directory_entry`
+    [[nodiscard]] operator const std::filesystem::path&() const noexcept {
+        return path();
+    }
+
+    [[nodiscard]] std::filesystem::file_type type() const noexcept {
+        return type_value;
+    }
+    [[nodiscard]] bool is_directory() const noexcept {
+        return type() == std::filesystem::file_type::directory;
+    }
+    [[nodiscard]] bool is_regular_file() const noexcept {
+        return type() == std::filesystem::file_type::regular;
+    }
+    [[nodiscard]] bool is_symlink() const noexcept {
+        return type() == std::filesystem::file_type::symlink;
+    }
+
+    /**
+     * Returns cached size, or queries it if metadata was not requested.
+     *
+     * @throws std::filesystem::filesystem_error if it cannot be queried
+     */
+    [[nodiscard]] std::uintmax_t file_size() const {
+        return has_status ? size_value : std::filesystem::file_size(path());
+    }
+    /**
+     * Returns cached time, or queries it if metadata was not requested.
+     *
+     * @throws std::filesystem::filesystem_error if it cannot be queried
+     */
+    [[nodiscard]] std::filesystem::file_time_type last_write_time() const {
+        return has_status ? time_value
+                          : std::filesystem::last_write_time(path());
+    }
+
+    bool operator==(const entry& other) const noexcept {
+        return path() == other.path();
+    }
+    std::strong_ordering operator<=>(const entry& other) const noexcept {
+        return path().compare(other.path()) <=> 0;
+    }
+
+    private:
+    friend class explorer_impl;
+
+    std::filesystem::path path_value{};
+    std::filesystem::file_type type_value{};
+    std::uintmax_t size_value{};
+    std::filesystem::file_time_type time_value{};
+    bool has_status{};
+};
+
+/**
+ * Entry viewed in place in the listing of its directory, without building
+ * its path. Only valid until the explorer which returned it advances.
+ */
+struct entry_view {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    const std::filesystem::path& directory;
+    std::basic_string_view<std::filesystem::path::value_type> name{};
+    std::filesystem::file_type type{};
+    // Only filled in if `explorer_options::metadata` is set
+    std::uintmax_t size{};
+    std::filesystem::file_time_type last_write_time{};
+};
+
+/**
+ * Part of a walk split between multiple explorers, such as in separate
+ * processes, which together return each entry exactly once.
+ */
+struct explorer_shard {
+    /**
+     * Index of this part, less than `count`.
+     */
+    std::size_t index{};
+
+    /**
+     * Number of parts, with 0 and 1 disabling sharding.
+     */
+    std::size_t count{};
+
+    /**
+     * Depth below roots down to which directories are split between parts.
+     *
+     * Directories above it are read by every part, each keeping only its own
+     * entries, while those at it are assigned whole. Deeper split keeps parts
+     * balanced when roots hold only a few directories, at the cost of
+     * reading more of the tree in every part. 0 is the same as 1.
+     */
+    std::size_t depth{ 3 };
+};
+
+/**
+ * Bounds on size and last write time of returned files, all inclusive.
+ * Directories are not bounded.
+ */
+struct metadata_bounds {
+    std::uintmax_t min_size{};
+    std::uintmax_t max_size{ std::numeric_limits<std::uintmax_t>::max() };
+    std::filesystem::file_time_type min_time{
+        std::filesystem::file_time_type::min()
+    };
+    std::filesystem::file_time_type max_time{
+        std::filesystem::file_time_type::max()
+    };
+
+    [[nodiscard]] bool empty() const noexcept {
+        return *this == metadata_bounds{};
+    }
+
+    [[nodiscard]] bool contains(
+            std::uintmax_t size, std::filesystem::file_time_type time
+    ) const noexcept {
+        return min_size <= size && size <= max_size && min_time <= time
+                && time <= max_time;
+    }
+
+    bool operator==(const metadata_bounds& other) const noexcept = default;
+};
+
 /**
  * Provides additional options to explorer.
  */
@@ -21,6 +178,140 @@ struct explorer_options {
      * @see glug::filter::select
      */
     filter::select select{};
+
+    /**
+     * Number of worker threads reading and filtering directories ahead of
+     * the consumer. Values 0 and 1 keep the walk on the calling thread.
+     *
+     * Output order is the same regardless of the number of threads.
+     */
+    std::size_t threads{};
+
+    /**
+     * Maximum number of directories read ahead of the consumer, nearest in
+     * iteration order first, while it drains the current one.
+     *
+     * If non-zero, a background thread is used even if `threads` is 0 or 1.
+     * If zero, all `threads` read the rest of the tree ahead, as far as a
+     * fixed limit of directories read but not yet walked.
+     */
+    std::size_t lookahead{};
+
+    /**
+     * Return entries in the order they are read, without sorting.
+     *
+     * Directories are streamed straight from the directory reader instead
+     * of being read whole, so memory is proportional to depth of the tree
+     * instead of size of the largest directory. `threads` and `lookahead`
+     * are ignored.
+     *
+     * Like with `std::filesystem::directory_iterator`, copies of explorer
+     * share their position and incrementing one invalidates the others.
+     *
+     * @see glug::filesystem::directory_reader
+     */
+    bool unordered{};
+
+    /**
+     * Query size and last write time of files while reading directories,
+     * to be returned by `entry::file_size` and `entry::last_write_time`.
+     *
+     * Files of each directory are queried together before filtering,
+     * in a single batch where supported.
+     *
+     * @see glug::filesystem::directory_reader::status
+     */
+    bool metadata{};
+
+    /**
+     * Return only files within bounds, checked against metadata read along
+     * with directories, so that filtering needs no query per file.
+     *
+     * Implies `metadata` unless empty.
+     */
+    metadata_bounds bounds{};
+
+    /**
+     * Follow symlinks, returning links to files like files and descending
+     * into links to directories, instead of skipping both.
+     *
+     * Each directory is walked only once, by the first path leading to it
+     * in iteration order, which also stops loops of links.
+     */
+    bool follow_symlinks{};
+
+    /**
+     * Descend into repositories nested in the walked one, such as submodules
+     * or vendored repositories, instead of skipping them.
+     *
+     * Like with `git ls-files --recurse-submodules`, each is filtered only by
+     * its own rules. Sharing no rules with the rest of the walk, they are
+     * read ahead in full by `threads` even if `lookahead` is set.
+     */
+    bool nested_repositories{};
+
+    /**
+     * Upstream of per-directory arenas, which hold entries of a directory
+     * read ahead of or by the consumer, and are released at once when
+     * the explorer and all its copies leave it.
+     *
+     * Must be thread-safe if `threads` or `lookahead` are used.
+     * If null, `std::pmr::get_default_resource` is used.
+     */
+    std::pmr::memory_resource* memory_resource{};
+
+    /**
+     * Called with each directory before it is read, skipping it along with
+     * everything below if it returns true. Roots are never pruned.
+     *
+     * Only called for directories not excluded by filters. Directories may
+     * be read ahead of the consumer, so it must be thread-safe if `threads`
+     * or `lookahead` are used.
+     */
+    std::function<bool(const std::filesystem::path&)> prune{};
+
+    /**
+     * Returns only entries of the given shard, so that a walk can be split
+     * between several explorers, e.g. one per process or machine.
+     *
+     * Entries are assigned to shards by hash of their path relative to the
+     * root, stable across platforms, and directories at `shard.depth`
+     * together with everything below them. Directories of other shards
+     * below that depth are thus never read.
+     */
+    explorer_shard shard{};
+
+    /**
+     * Source of directories to walk instead of the real filesystem,
+     * e.g. an in-memory tree to measure filtering without any I/O.
+     *
+     * Roots and paths of entries are then those of the source.
+     * Must be thread-safe if `threads` or `lookahead` are used.
+     *
+     * @see glug::filesystem::memory_tree
+     */
+    std::shared_ptr<const directory_source> source{};
+};
+
+/**
+ * Counts of system calls made or avoided by explorer.
+ */
+struct explorer_stats {
+    /**
+     * Entries read from directories, before filtering.
+     */
+    std::size_t entries{};
+
+    /**
+     * Entries classified only by type reported while reading directory.
+     */
+    std::size_t stats_avoided{};
+
+    /**
+     * Entries which needed a `stat`, as filesystem did not report type,
+     * or because `explorer_options::metadata` was requested.
+     */
+    std::size_t stats{};
 };
 
 /**
@@ -34,7 +325,7 @@ class explorer {
 
     public:
     using difference_type = std::ptrdiff_t;
-    using value_type = std::filesystem::directory_entry;
+    using value_type = entry;
     using pointer = const value_type*;
     using reference = const value_type&;
     using iterator_category = std::input_iterator_tag;
@@ -47,6 +338,22 @@ class explorer {
             const std::filesystem::path& root, const explorer_options& options
     );
 
+    /**
+     * Lists contents of multiple directories in a single pass, in given order.
+     *
+     * Ignore rules found above the roots are read only once for all of them.
+     * Roots repeated are walked only once. Roots nested in other roots are
+     * walked in their own place in the order, and skipped by walks of the
+     * outer ones, so they are listed even if those would not descend there.
+     */
+    explicit explorer(const std::vector<std::filesystem::path>& roots) :
+        explorer(roots, {}) {}
+
+    explorer(
+            const std::vector<std::filesystem::path>& roots,
+            const explorer_options& options
+    );
+
     [[nodiscard]] explorer begin() const noexcept { return *this; }
     // NOLINTNEXTLINE(readability-convert-member-functions-to-static): interface
     [[nodiscard]] explorer end() const noexcept { return {}; }
@@ -58,20 +365,198 @@ class explorer {
 
     bool operator==(const explorer& other) const noexcept;
 
+    /**
+     * Skips subdirectories of the directory of the current entry, which
+     * have not been entered yet. Its remaining files are still returned.
+     *
+     * Unlike `std::filesystem::recursive_directory_iterator`, directories
+     * are not returned, so the decision is made on one of their files.
+     * Copies are not affected.
+     */
+    void disable_recursion_pending();
+
+    /**
+     * Fills `batch` with up to its size next entries, advancing past them.
+     *
+     * Same as dereferencing and incrementing in a loop, but with less work
+     * per entry. Storage of entries already in `batch` is reused, so filling
+     * the same buffer repeatedly mostly avoids allocating paths.
+     *
+     * @returns number of entries filled, fewer than requested only at the end
+     */
+    std::size_t next_batch(std::span<entry> batch);
+
+    /**
+     * Calls `visit` with up to `limit` next entries, advancing past them.
+     *
+     * Same as `next_batch`, but entries are viewed in place, so that no path
+     * is built at all. `visit` must not use the explorer itself.
+     *
+     * @returns number of entries visited, fewer than `limit` only at the end
+     */
+    std::size_t visit_batch(
+            std::size_t limit, const std::function<void(const entry_view&)>& visit
+    );
+
+    /**
+     * Serializes position of the walk, to be resumed later with `restore`.
+     *
+     * Only the remaining roots and the names on the path to the current
+     * entry are stored, along with directories skipped by
+     * `disable_recursion_pending` and, when following symlinks, those
+     * already walked. The blob thus stays small regardless of size of
+     * directories. Ignore rules are not stored, but read again on restore.
+     *
+     * @throws std::logic_error in unordered mode, as read order of directory
+     *     cannot be reproduced
+     */
+    [[nodiscard]] std::string checkpoint() const;
+
+    /**
+     * Resumes walk from a `checkpoint`, reading again only the directories
+     * on the path to the entry it was taken at, along with their rules.
+     *
+     * Options are not part of the checkpoint and should match those used
+     * before. If directories changed in the meantime, the walk resumes from
+     * the first entry not before the one current at the checkpoint.
+     *
+     * @throws std::invalid_argument if the checkpoint is malformed
+     * @throws std::logic_error in unordered mode, same as `checkpoint`
+     */
+    [[nodiscard]] static explorer restore(
+            std::string_view checkpoint, const explorer_options& options = {}
+    );
+
+    /**
+     * Returns counts of system calls for the whole walk so far.
+     *
+     * Counts are shared with copies, and include work of worker threads.
+     */
+    [[nodiscard]] explorer_stats stats() const noexcept;
+
     private:
     friend class explorer_impl;
 
-    struct level {
-        filter::ignore filter{};
-        // PERF: Try using just iterator, without sorting whole directory
-        std::deque<std::filesystem::directory_entry> entries{};
+    struct prefetcher;
+    struct counters;
+
+    using name_view = std::basic_string_view<std::filesystem::path::value_type>;
+
+    // Entry of a table, viewing its name, full path is only built when
+    // dereferenced
+    struct item {
+        name_view name{};
+        std::filesystem::file_type type{};
+        // Only filled in if `explorer_options::metadata` is set
+        std::uintmax_t size{};
+        std::filesystem::file_time_type last_write_time{};
+
+        bool operator==(const item& other) const noexcept = default;
+    };
+
+    // Entries of a directory in parallel arrays, with all names in a single
+    // buffer, so that each entry costs only a few bytes besides its name
+    struct table {
+        table() : table(std::pmr::get_default_resource()) {}
+        explicit table(std::pmr::memory_resource* resource);
+        table(const table& other, std::pmr::memory_resource* resource);
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return types.size();
+        }
+        [[nodiscard]] bool empty() const noexcept { return types.empty(); }
+        [[nodiscard]] item operator[](std::size_t index) const noexcept;
+        [[nodiscard]] const std::filesystem::path::value_type*
+        c_str(std::size_t index) const noexcept;
+        // Upper bound of bytes needed to copy the table
+        [[nodiscard]] std::size_t footprint() const noexcept;
+        void append(name_view name, std::filesystem::file_type type);
+        void clear() noexcept;
+
+        bool operator==(const table& other) const noexcept = default;
+
+        // Each name is followed by null terminator, as needed by system calls
+        std::pmr::basic_string<std::filesystem::path::value_type> names;
+        // Start of each name, followed by the end of the last one
+        std::pmr::vector<std::uint32_t> offsets;
+        std::pmr::vector<std::filesystem::file_type> types;
+        // Only filled in if `explorer_options::metadata` is set
+        std::pmr::vector<std::uintmax_t> sizes;
+        std::pmr::vector<std::filesystem::file_time_type> times;
+    };
+
+    // Directory read and filtered, never modified afterwards, so that it can
+    // be shared by copies of explorer and by workers reading its children
+    struct listing {
+        // Rules of this directory merged with those inherited from parents,
+        // or the parent's own if there are none, null if there are no rules
+        std::shared_ptr<const filter::ignore> filter{};
+        // Sparse checkout cone of this directory, null if all of it is
+        // checked out
+        std::shared_ptr<const filter::cone> cone{};
+        // Declared before entries, which are allocated from it
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> arena{};
+        // Left empty in unordered mode, which streams from `directory`
+        table entries{};
+        // Indices of entries left after filtering, in iteration order
+        std::pmr::vector<std::uint32_t> order{};
         bool is_root{};
+        // Root of repository nested in another, only walked if requested
+        bool is_nested{};
+        // Entries are split between shards, set for roots of the walk and
+        // directories above `explorer_shard::depth` below them
+        bool is_sharded{};
+        // Depth below root of the walk, and hash of path relative to it, from
+        // which hashes of entries are continued, only set if sharded
+        std::size_t shard_depth{};
+        std::uint64_t shard_hash{};
+        std::filesystem::path path{};
+        // Generic `path` with trailing separator, to build paths for filters
+        std::string prefix{};
+        // Kept open to open subdirectories, and to read them in unordered mode
+        directory_reader directory{};
+        // Only queried when following symlinks
+        file_id id{};
+    };
+
+    // Position within listing, linked to the level of its parent directory.
+    // Levels are shared by copies of explorer and copied only when advanced
+    // while shared, so that copying explorer is O(1) regardless of depth.
+    struct level {
+        std::shared_ptr<const listing> contents{};
+        std::shared_ptr<level> parent{};
+        // Index into `listing::order`
+        std::size_t position{};
+        // Holds just the current entry in unordered mode
+        table streamed{};
+        // Remaining subdirectories are skipped
+        bool pruned{};
 
         bool operator==(const level& other) const noexcept;
     };
 
-    std::vector<level> stack{};
-    explorer_options options{};
+    // Directory to walk, with levels of rules found above it
+    struct root {
+        std::filesystem::path path{};
+        std::shared_ptr<level> outer{};
+    };
+
+    std::shared_ptr<level> top{};
+    // Shared between copies, as never modified after construction
+    std::shared_ptr<const std::vector<root>> roots{};
+    // Index of root to walk once the current one is exhausted
+    std::size_t next_root{};
+    // Roots nested in other roots, as paths the walks of those reach them by,
+    // which skip them to leave them to their own walk
+    std::shared_ptr<const std::vector<std::filesystem::path>> nested_roots{};
+    std::shared_ptr<const explorer_options> options{};
+    mutable std::optional<entry> current{};
+    // Directories already walked, only filled when following symlinks.
+    // Shared between copies until either of them walks a new one.
+    std::shared_ptr<std::unordered_set<file_id>> visited{};
+    std::shared_ptr<counters> counts{};
+    // Shared between copies, so that prefetched results are not lost
+    std::shared_ptr<prefetcher> prefetch{};
 };
 
 }  // namespace glug::filesystem
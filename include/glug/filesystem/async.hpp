@@ -0,0 +1,137 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#pragma once
+
+#include "glug/filesystem.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace glug::filesystem {
+
+/**
+ * Runs blocking work submitted by asynchronous explorer, on any thread.
+ *
+ * Each task must be called exactly once. It performs the blocking read,
+ * then resumes the explorer, and through it the consumer, on the same thread.
+ */
+using executor = std::function<void(std::function<void()>)>;
+
+/**
+ * Lazy sequence of values produced by a coroutine, which may suspend
+ * between values to wait for asynchronous work.
+ *
+ * Consumer is itself a coroutine, awaiting `next` until it returns nothing.
+ * Generator must not be destroyed while `next` is being awaited.
+ */
+template <typename T>
+class async_generator {
+    public:
+    struct promise_type;
+    using handle = std::coroutine_handle<promise_type>;
+
+    // Returns control to whoever awaits `next`, or to its resumer if none
+    struct yield_awaiter {
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        [[nodiscard]] std::coroutine_handle<>
+        await_suspend(handle coroutine) const noexcept {
+            return coroutine.promise().consumer;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type {
+        std::optional<T> current{};
+        std::coroutine_handle<> consumer{ std::noop_coroutine() };
+        std::exception_ptr error{};
+
+        async_generator get_return_object() noexcept {
+            return async_generator{ handle::from_promise(*this) };
+        }
+        [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+        [[nodiscard]] yield_awaiter final_suspend() const noexcept {
+            return {};
+        }
+        yield_awaiter yield_value(T value) {
+            current.emplace(std::move(value));
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept {
+            error = std::current_exception();
+        }
+    };
+
+    struct next_awaiter {
+        handle coroutine{};
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return !coroutine || coroutine.done();
+        }
+        [[nodiscard]] std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<> consumer) const noexcept {
+            coroutine.promise().consumer = consumer;
+            return coroutine;
+        }
+        std::optional<T> await_resume() const {
+            if (!coroutine) {
+                return std::nullopt;
+            }
+            auto& promise = coroutine.promise();
+            if (promise.error) {
+                std::rethrow_exception(std::exchange(promise.error, {}));
+            }
+            return std::exchange(promise.current, std::nullopt);
+        }
+    };
+
+    async_generator() noexcept = default;
+    async_generator(const async_generator&) = delete;
+    async_generator(async_generator&& other) noexcept :
+        coroutine{ std::exchange(other.coroutine, {}) } {}
+    async_generator& operator=(const async_generator&) = delete;
+    async_generator& operator=(async_generator&& other) noexcept {
+        std::swap(coroutine, other.coroutine);
+        return *this;
+    }
+    ~async_generator() {
+        if (coroutine) {
+            coroutine.destroy();
+        }
+    }
+
+    /**
+     * Resumes the generator until it produces next value.
+     *
+     * @returns awaitable of next value, or nothing once finished
+     * @throws anything thrown by the generator, when awaited
+     */
+    [[nodiscard]] next_awaiter next() const noexcept { return { coroutine }; }
+
+    private:
+    explicit async_generator(handle coroutine) noexcept :
+        coroutine{ coroutine } {}
+
+    handle coroutine{};
+};
+
+/**
+ * Recursively lists directory contents without blocking the caller.
+ *
+ * Results and filtering are exactly the same as with `explorer`, but each
+ * directory read, including loading its .gitignore, is submitted to
+ * `executor` instead. After that the consumer is resumed on the executor's
+ * thread, and is only suspended again on the next read.
+ *
+ * `threads`, `lookahead` and `unordered` options are ignored.
+ */
+[[nodiscard]] async_generator<entry> explore_async(
+        std::filesystem::path root, explorer_options options, executor executor
+);
+
+}  // namespace glug::filesystem
@@ -0,0 +1,244 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace glug::filesystem {
+
+namespace detail {
+struct directory;
+
+/**
+ * Limits entries submitted to io_uring by one system call on this thread, or
+ * lifts the limit if zero, so that tests can force partial submits.
+ */
+void limit_submissions(unsigned limit);
+}  // namespace detail
+
+/**
+ * Name and type of directory entry, exactly as reported by the system.
+ *
+ * Type is `std::filesystem::file_type::unknown` if the underlying filesystem
+ * does not provide it while listing directories.
+ */
+struct raw_entry {
+    std::basic_string_view<std::filesystem::path::value_type> name{};
+    std::filesystem::file_type type{};
+};
+
+/**
+ * Type, size and last write time of directory entry, as reported by `stat`.
+ */
+struct raw_status {
+    std::filesystem::file_type type{};
+    std::uintmax_t size{};
+    std::filesystem::file_time_type last_write_time{};
+};
+
+/**
+ * Identity of a file, shared by all paths and links leading to it.
+ */
+struct file_id {
+    std::uint64_t device{};
+    std::uint64_t inode{};
+
+    bool operator==(const file_id& other) const noexcept = default;
+};
+
+/**
+ * Custom implementation of open directory, read through `directory_reader`,
+ * e.g. to walk an in-memory tree instead of the real filesystem.
+ *
+ * Each method has the same contract as that of `directory_reader`.
+ *
+ * @see glug::filesystem::memory_tree
+ */
+class directory_handle {
+    public:
+    directory_handle() noexcept = default;
+    directory_handle(const directory_handle&) = delete;
+    directory_handle(directory_handle&&) = delete;
+    directory_handle& operator=(const directory_handle&) = delete;
+    directory_handle& operator=(directory_handle&&) = delete;
+    virtual ~directory_handle() = default;
+
+    [[nodiscard]] virtual std::shared_ptr<directory_handle>
+    open(const std::filesystem::path& name, bool follow_symlinks) const = 0;
+    [[nodiscard]] virtual file_id id() const = 0;
+    [[nodiscard]] virtual std::optional<raw_entry> next() = 0;
+    [[nodiscard]] virtual std::filesystem::file_type
+    type(const std::filesystem::path& name) const = 0;
+    [[nodiscard]] virtual std::vector<raw_status> status(
+            std::span<const std::filesystem::path::value_type* const> names,
+            bool follow_symlinks
+    ) const = 0;
+    [[nodiscard]] virtual std::string
+    read(const std::filesystem::path& name) const = 0;
+};
+
+/**
+ * Low-level reader of directory contents.
+ *
+ * On Linux, directories are held open by file descriptor, so that their
+ * children are opened with `openat` without resolving the whole path again,
+ * and read with `getdents64` into large buffers reused between directories.
+ * Other systems fall back to `std::filesystem::directory_iterator`.
+ *
+ * Similarly to `std::filesystem::directory_iterator`, copies share state.
+ */
+class directory_reader {
+    public:
+    directory_reader() noexcept = default;
+
+    /**
+     * Opens directory by path.
+     *
+     * @throws std::filesystem::filesystem_error if it cannot be opened
+     */
+    explicit directory_reader(const std::filesystem::path& path);
+
+    /**
+     * Reads directory of custom implementation, as do its subdirectories.
+     */
+    explicit directory_reader(
+            std::shared_ptr<directory_handle> handle
+    ) noexcept :
+        handle{ std::move(handle) } {}
+
+    /**
+     * Opens subdirectory of already open directory.
+     *
+     * Symlinks are not followed, unless requested.
+     *
+     * @throws std::filesystem::filesystem_error if it cannot be opened
+     */
+    directory_reader(
+            const directory_reader& parent,
+            const std::filesystem::path& name,
+            bool follow_symlinks = false
+    );
+
+    [[nodiscard]] bool is_open() const noexcept {
+        return pimpl != nullptr || handle != nullptr;
+    }
+
+    /**
+     * Queries identity of the directory itself, e.g. to detect loops.
+     *
+     * @returns identity, or default value if it cannot be queried
+     */
+    [[nodiscard]] file_id id() const;
+
+    /**
+     * Releases the underlying handle, once all copies have released it.
+     */
+    void close() noexcept {
+        pimpl = nullptr;
+        handle = nullptr;
+    }
+
+    /**
+     * Reads next entry, skipping "." and "..".
+     *
+     * The name is only valid until next call.
+     *
+     * @returns entry, or nothing if all entries have been read
+     * @throws std::filesystem::filesystem_error if reading fails
+     */
+    [[nodiscard]] std::optional<raw_entry> next();
+
+    /**
+     * Checks if entry of given name exists, without following symlinks.
+     */
+    [[nodiscard]] bool contains(const std::filesystem::path& name) const;
+
+    /**
+     * Queries type of entry without following symlinks.
+     *
+     * Meant for entries with `unknown` type, costs a system call.
+     *
+     * @returns type, or `std::filesystem::file_type::not_found`
+     */
+    [[nodiscard]] std::filesystem::file_type
+    type(const std::filesystem::path& name) const;
+
+    /**
+     * Queries status of many entries at once.
+     *
+     * On Linux, `statx` of all entries is submitted in batches through
+     * io_uring, falling back to `fstatat` per entry if it is unavailable.
+     *
+     * @param names null-terminated names of entries
+     * @param follow_symlinks query targets of symlinks instead of links
+     * @returns status per name, with `std::filesystem::file_type::not_found`
+     *          type if it cannot be queried
+     */
+    [[nodiscard]] std::vector<raw_status> status(
+            std::span<const std::filesystem::path::value_type* const> names,
+            bool follow_symlinks = false
+    ) const;
+
+    /**
+     * Reads whole contents of a file in the directory.
+     *
+     * @returns contents, or empty string if it cannot be read
+     */
+    [[nodiscard]] std::string read(const std::filesystem::path& name) const;
+
+    private:
+    std::shared_ptr<detail::directory> pimpl{};
+    // Used instead of `pimpl` if set
+    std::shared_ptr<directory_handle> handle{};
+};
+
+/**
+ * Source of directories walked by explorer, replacing the real filesystem.
+ *
+ * @see glug::filesystem::explorer_options::source
+ */
+class directory_source {
+    public:
+    directory_source() noexcept = default;
+    directory_source(const directory_source&) = default;
+    directory_source(directory_source&&) = default;
+    directory_source& operator=(const directory_source&) = default;
+    directory_source& operator=(directory_source&&) = default;
+    virtual ~directory_source() = default;
+
+    /**
+     * Opens directory by path.
+     *
+     * @throws std::filesystem::filesystem_error if it cannot be opened
+     */
+    [[nodiscard]] virtual directory_reader
+    open(const std::filesystem::path& path) const = 0;
+
+    /**
+     * Resolves path into the only absolute form of the same directory,
+     * used to find directories above it.
+     *
+     * @throws std::filesystem::filesystem_error if it does not exist
+     */
+    [[nodiscard]] virtual std::filesystem::path
+    canonical(const std::filesystem::path& path) const = 0;
+};
+
+}  // namespace glug::filesystem
+
+template <>
+struct std::hash<glug::filesystem::file_id> {
+    std::size_t operator()(const glug::filesystem::file_id& id) const noexcept {
+        // Device rarely differs between directories of the same tree
+        return std::hash<std::uint64_t>{}(id.inode ^ (id.device << 48U));
+    }
+};
@@ -0,0 +1,84 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#pragma once
+
+#include "glug/filesystem/directory.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace glug::filesystem {
+
+/**
+ * Directory tree held in memory, to be walked by explorer instead of
+ * the real filesystem, e.g. to measure filtering without any I/O.
+ *
+ * Paths are relative to root of the tree, which is also reachable as "/".
+ * Only regular files have contents, symlinks cannot be followed.
+ *
+ * Copies share the tree, which must not be modified while being walked.
+ */
+class memory_tree : public directory_source {
+    public:
+    memory_tree();
+
+    /**
+     * Parses tree from a listing, as produced by `listing`.
+     *
+     * Each line holds a path, with '/' after directories and '@' after
+     * symlinks. Lines of contents follow their file, indented by a tab.
+     * Parent directories are added implicitly.
+     */
+    [[nodiscard]] static memory_tree parse(std::string_view listing);
+
+    /**
+     * Records tree of a real directory, with contents of `.gitignore` and
+     * `.git` files only. Of git directories, only files read by explorer are
+     * recorded, i.e. config and sparse checkout patterns, including those
+     * `.git` files of worktrees and submodules point to within the tree.
+     *
+     * @throws std::filesystem::filesystem_error if it cannot be read
+     */
+    [[nodiscard]] static memory_tree record(const std::filesystem::path& root);
+
+    /**
+     * Serializes tree into a listing, which can be read by `parse`.
+     */
+    [[nodiscard]] std::string listing() const;
+
+    /**
+     * Adds a file, replacing any entry of the same path.
+     */
+    void add_file(
+            const std::filesystem::path& path, std::string contents = {}
+    );
+    /**
+     * Adds a directory, keeping contents of an existing one.
+     */
+    void add_directory(const std::filesystem::path& path);
+    /**
+     * Adds a symlink, replacing any entry of the same path.
+     */
+    void add_symlink(const std::filesystem::path& path);
+
+    [[nodiscard]] directory_reader
+    open(const std::filesystem::path& path) const override;
+    [[nodiscard]] std::filesystem::path
+    canonical(const std::filesystem::path& path) const override;
+
+    private:
+    struct node;
+    class handle;
+
+    node&
+    add(const std::filesystem::path& path, std::filesystem::file_type type);
+    void record_git(
+            const std::filesystem::path& source,
+            const std::filesystem::path& destination
+    );
+
+    std::shared_ptr<node> root{};
+};
+
+}  // namespace glug::filesystem
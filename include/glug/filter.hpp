@@ -4,11 +4,18 @@
 #include "glug/glob.hpp"
 #include "glug/regex.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <optional>
 #include <span>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace glug::filter {
@@ -59,6 +66,15 @@ class ignore {
     ignore(std::span<const std::string_view> globs,
            const std::filesystem::path& anchor);
 
+    /**
+     * Merges filter of a directory with the one inherited from its parent,
+     * deciding the same as checking `nested` first, then `parent` only
+     * if `nested` is undecided.
+     */
+    ignore(const ignore& parent, const ignore& nested);
+
+    [[nodiscard]] bool empty() const noexcept { return items.empty(); }
+
     /**
      * Check a file or directory against the list of globs.
      * @see decision
@@ -66,6 +82,15 @@ class ignore {
     [[nodiscard]] decision
     apply(const std::filesystem::directory_entry& entry) const noexcept;
 
+    /**
+     * Check a path against the list of globs, without accessing filesystem.
+     *
+     * Path must use '/' as separator.
+     * @see decision
+     */
+    [[nodiscard]] decision
+    apply(std::string_view path, bool is_directory) const noexcept;
+
     [[nodiscard]] decision
     operator()(const std::filesystem::directory_entry& entry) const noexcept {
         return apply(entry);
@@ -108,6 +133,10 @@ class select {
 
     select(std::string_view globs, const std::filesystem::path& anchor);
 
+    [[nodiscard]] bool empty() const noexcept {
+        return files.empty() && dirs.empty();
+    }
+
     /**
      * Check a file or directory against the list of globs.
      *
@@ -123,11 +152,41 @@ class select {
     [[nodiscard]] decision
     apply(const std::filesystem::directory_entry& entry) const noexcept;
 
+    /**
+     * Check a path against the list of globs, without accessing filesystem.
+     *
+     * Path must use '/' as separator.
+     * @see apply
+     */
+    [[nodiscard]] decision
+    apply(std::string_view path, bool is_directory) const noexcept;
+
     [[nodiscard]] decision
     operator()(const std::filesystem::directory_entry& entry) const noexcept {
         return apply(entry);
     }
 
+    /**
+     * Checks if directory may contain any selected files.
+     *
+     * Only anchored globs can rule out directories, so this is always true
+     * if any positive file glob is not anchored.
+     *
+     * Path must use '/' as separator, without trailing one.
+     */
+    [[nodiscard]] bool may_contain(std::string_view directory) const noexcept;
+
+    /**
+     * Lists the only subdirectories of directory which may contain selected
+     * files, if all globs reaching it continue with literal names.
+     *
+     * Path must use '/' as separator, without trailing one.
+     *
+     * @returns sorted names, or nothing if any entry may be selected
+     */
+    [[nodiscard]] std::optional<std::vector<std::string>>
+    subdirectories(std::string_view directory) const;
+
     private:
     struct ignore_item {
         bool is_inverted{};
@@ -135,10 +194,110 @@ class select {
         regex::engine regex{};
     };
 
+    // Part of anchored glob between separators
+    struct segment {
+        // Empty unless segment has no wildcards
+        std::string literal{};
+        bool is_globstar{};
+        regex::engine regex{};
+    };
+
     std::vector<ignore_item> files{};
     std::vector<ignore_item> dirs{};
     decision files_fallback{};
     decision dirs_fallback{};
+    // Positive file globs split into segments, empty unless all are anchored
+    std::vector<std::vector<segment>> scopes{};
+    // Anchor with trailing separator, unlike in globs not escaped
+    std::string scope_anchor{};
+};
+
+/**
+ * Directories of a sparse checkout in cone mode, outside which nothing is
+ * checked out, as described by `.git/info/sparse-checkout`.
+ *
+ * Files directly in the root and in parents of listed directories are
+ * always checked out, so only directories are filtered.
+ */
+class cone {
+    public:
+    cone() noexcept = default;
+
+    /**
+     * Parses patterns written by `git sparse-checkout set --cone`.
+     *
+     * @returns nothing if any pattern is not of cone mode, which cannot be
+     *          decided by directory alone
+     */
+    [[nodiscard]] static std::optional<cone> parse(std::string_view patterns);
+
+    /**
+     * Whether the whole directory is checked out, along with everything
+     * below it.
+     */
+    [[nodiscard]] bool is_recursive() const noexcept {
+        return is_included && !is_parent;
+    }
+
+    /**
+     * Cone of subdirectory, itself for recursive cone.
+     *
+     * @returns null if subdirectory is outside the cone
+     */
+    [[nodiscard]] const cone* subdirectory(std::string_view name) const;
+
+    private:
+    cone& add(std::string_view directory);
+
+    std::string name{};
+    // Sorted by name
+    std::vector<cone> children{};
+    // Listed as `/dir/`
+    bool is_included{};
+    // Listed as `!/dir/*/`, limiting it to files and listed subdirectories
+    bool is_parent{};
+};
+
+/**
+ * Sorts files into typetags by name, e.g. to count files per language.
+ *
+ * Unlike with `select`, a file may belong to any number of tags, or none.
+ *
+ * @see glug::glob::typetag_database
+ */
+class typetags {
+    public:
+    typetags() noexcept = default;
+
+    /**
+     * @param tags comma-separated globs of each tag, as in typetag database
+     */
+    explicit typetags(
+            const std::unordered_map<std::string_view, std::string_view>& tags
+    );
+
+    /**
+     * Sorted names of tags, indexed by `match`.
+     */
+    [[nodiscard]] const std::vector<std::string>& names() const noexcept {
+        return tag_names;
+    }
+
+    /**
+     * Finds tags with any glob matching file name.
+     *
+     * @param indices replaced with ascending indices into `names`
+     */
+    void match(std::string_view name, std::vector<std::size_t>& indices) const;
+
+    private:
+    std::vector<std::string> tag_names{};
+    // Tags of globs like `*.cpp`, so that most names need a single lookup
+    std::map<std::string, std::vector<std::size_t>, std::less<>> extensions{};
+    // Tags of globs without wildcards, like `CMakeLists.txt`
+    std::map<std::string, std::vector<std::size_t>, std::less<>> exact{};
+    // Tags of all other globs, like `[mM]akefile`
+    std::vector<std::pair<std::size_t, regex::engine>> others{};
 };
 
 }  // namespace glug::filter
@@ -0,0 +1,109 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/detail/thread_pool.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace glug::detail {
+
+namespace {
+
+// Identifies the pool and queue of a worker, to keep its subtasks local
+thread_local const thread_pool* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+}  // namespace
+
+thread_pool::thread_pool(std::size_t threads) {
+    locals.reserve(threads);
+    for (auto i = std::size_t{ 0 }; i < threads; i++) {
+        locals.emplace_back(std::make_unique<queue>());
+    }
+    workers.reserve(threads);
+    for (auto i = std::size_t{ 0 }; i < threads; i++) {
+        workers.emplace_back([this, i] { run(i); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        const auto lock = std::scoped_lock{ shared.mutex };
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void thread_pool::submit(task work) {
+    // Count first, so that a racing pop can never underflow `pending`
+    {
+        const auto lock = std::scoped_lock{ shared.mutex };
+        pending++;
+        if (current_pool != this) {
+            shared.tasks.emplace_back(std::move(work));
+        }
+    }
+    if (current_pool == this) {
+        auto& local = *locals[current_index];
+        const auto lock = std::scoped_lock{ local.mutex };
+        local.tasks.emplace_back(std::move(work));
+    }
+    wakeup.notify_one();
+}
+
+bool thread_pool::try_pop(std::size_t index, task& work) {
+    const auto pop = [this, &work](queue& queue, bool back) {
+        {
+            const auto lock = std::scoped_lock{ queue.mutex };
+            if (queue.tasks.empty()) {
+                return false;
+            }
+            auto& source = back ? queue.tasks.back() : queue.tasks.front();
+            work = std::move(source);
+            if (back) {
+                queue.tasks.pop_back();
+            } else {
+                queue.tasks.pop_front();
+            }
+        }
+        const auto lock = std::scoped_lock{ shared.mutex };
+        pending--;
+        return true;
+    };
+
+    if (pop(*locals[index], true) || pop(shared, false)) {
+        return true;
+    }
+    for (auto i = std::size_t{ 1 }; i < locals.size(); i++) {
+        if (pop(*locals[(index + i) % locals.size()], false)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void thread_pool::run(std::size_t index) {
+    current_pool = this;
+    current_index = index;
+    auto work = task{};
+    while (true) {
+        if (try_pop(index, work)) {
+            work();
+            work = nullptr;
+            continue;
+        }
+
+        auto lock = std::unique_lock{ shared.mutex };
+        wakeup.wait(lock, [this] { return stopping || pending > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+}  // namespace glug::detail
@@ -1,72 +1,310 @@
 // Provided as part of glug under MIT license, (c) 2025-2026 Dominik Kaszewski
 #include "glug/filesystem.hpp"
 
+#include "glug/detail/thread_pool.hpp"
+#include "glug/filesystem/async.hpp"
+#include "glug/filesystem/directory.hpp"
 #include "glug/filter.hpp"
 #include "glug/glob.hpp"
 
 #include <algorithm>
-#include <deque>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace fs = std::filesystem;
+using name_view = std::basic_string_view<fs::path::value_type>;
 
 namespace glug::filesystem {
 
+namespace {
+
+struct path_hash {
+    std::size_t operator()(const fs::path& path) const noexcept {
+        return fs::hash_value(path);
+    }
+};
+
+// Buffer reused between calls on the same thread to avoid allocating, but
+// never by two calls at once, as a prune hook or directory source may run
+// another explorer from within the walk
+template <typename T>
+class reused {
+    public:
+    reused() :
+        value{ take() } {}
+    reused(const reused&) = delete;
+    reused(reused&&) = delete;
+    reused& operator=(const reused&) = delete;
+    reused& operator=(reused&&) = delete;
+    ~reused() {
+        // GCOVR_EXCL_START: Only fails on allocation failure
+        try {
+            spare().push_back(std::move(value));
+        } catch (...) {
+            // Not kept for reuse, then
+        }
+        // GCOVR_EXCL_STOP
+    }
+
+    T& operator*() noexcept { return value; }
+    T* operator->() noexcept { return &value; }
+
+    private:
+    static std::vector<T>& spare() noexcept {
+        thread_local auto buffers = std::vector<T>{};
+        return buffers;
+    }
+    static T take() {
+        auto& buffers = spare();
+        if (buffers.empty()) {
+            return T{};
+        }
+        auto result = std::move(buffers.back());
+        buffers.pop_back();
+        return result;
+    }
+
+    T value;
+};
+
+// Name of an entry viewed for sorting, with index of the entry
+struct sort_key {
+    const fs::path::value_type* name{};
+    std::uint32_t length{};
+    std::uint32_t index{};
+};
+
+// Character compared as unsigned, same as `std::char_traits::lt`, with end of
+// name before any character, so that prefixes sort before longer names
+int char_at(const sort_key& key, std::size_t depth) noexcept {
+    using unsigned_char = std::make_unsigned_t<fs::path::value_type>;
+    return depth < key.length ? static_cast<unsigned_char>(key.name[depth])
+                              : -1;
+}
+
+// Three-way radix quicksort of names sharing first `depth` characters.
+// Partitions on a single character at a time, so unlike comparison sort, it
+// does not compare common prefixes again on every comparison.
+void radix_sort(std::span<sort_key> keys, std::size_t depth) {
+    // Below that, partitioning costs more than it saves
+    static constexpr auto small = std::size_t{ 16 };
+    while (keys.size() > small) {
+        // Median of three, to not degrade on names already sorted
+        auto a = char_at(keys.front(), depth);
+        auto b = char_at(keys[keys.size() / 2], depth);
+        const auto c = char_at(keys.back(), depth);
+        if (a > b) {
+            std::swap(a, b);
+        }
+        const auto pivot = std::clamp(c, a, b);
+
+        auto less = std::size_t{};
+        auto greater = keys.size();
+        for (auto i = std::size_t{}; i < greater;) {
+            const auto current = char_at(keys[i], depth);
+            if (current < pivot) {
+                std::swap(keys[less++], keys[i++]);
+            } else if (current > pivot) {
+                std::swap(keys[i], keys[--greater]);
+            } else {
+                i++;
+            }
+        }
+
+        radix_sort(keys.first(less), depth);
+        // Names ending at this depth are equal, nothing left to compare
+        if (pivot >= 0) {
+            radix_sort(keys.subspan(less, greater - less), depth + 1);
+        }
+        keys = keys.subspan(greater);
+    }
+
+    const auto suffix = [depth](const sort_key& key) {
+        return name_view{ key.name, key.length }.substr(depth);
+    };
+    std::ranges::sort(keys, std::ranges::less{}, suffix);
+}
+
+}  // namespace
+
 // Allows adding helpers with private access without modifying header
 class explorer_impl {
     public:
+    using listing_ptr = std::shared_ptr<const explorer::listing>;
+    // Level as stored in checkpoint
+    struct saved_level {
+        fs::path path{};
+        // Name of the front entry, empty if exhausted
+        fs::path name{};
+        bool is_directory{};
+        bool pruned{};
+    };
+    // Levels of rules found above directories already visited
+    using outer_levels = std::unordered_map<
+            fs::path,
+            std::shared_ptr<explorer::level>,
+            path_hash>;
+
     // Transient helper, storing references to avoid passing to all functions
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
-    decltype(explorer::stack)& stack;
+    std::shared_ptr<explorer::level>& top;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
     const explorer_options& options;
+    explorer::counters& counts;
+    explorer::prefetcher* prefetch{};
+    // Not given to workers, which leave claiming directories to consumer
+    std::shared_ptr<std::unordered_set<file_id>>* visited{};
+    // See `explorer::nested_roots`
+    std::span<const fs::path> nested_roots{};
 
-    // `const` methods cannot construct instance without dropping qualifiers
-    [[nodiscard]] static const auto&
-    front(const std::vector<explorer::level>& stack) noexcept {
-        return stack.back().entries.front();
-    }
-    [[nodiscard]] const auto& front() const noexcept { return front(stack); }
-    void add_outer_filters(const fs::path& path);
-    void populate(const fs::path& path);
+    [[nodiscard]] static explorer::item
+    front(const explorer::level& level) noexcept;
+    [[nodiscard]] static bool exhausted(const explorer::level& level) noexcept;
+    [[nodiscard]] bool is_walk_root() const noexcept;
+    void shard(explorer::listing& listing) const;
+    [[nodiscard]] static entry make_entry(
+            const explorer::listing& listing,
+            const explorer::item& item,
+            const explorer_options& options
+    );
+    static void assign(
+            entry& target,
+            const explorer::listing& listing,
+            const explorer::item& item,
+            const explorer_options& options
+    );
+    static async_generator<entry>
+    walk(fs::path root, explorer_options options, executor submit);
+    void push(listing_ptr listing);
+    void unwind();
+    [[nodiscard]] explorer::level& own();
+    [[nodiscard]] static explorer_impl of(explorer& explorer);
+    static void prepare(explorer& explorer, const explorer_options& options);
+    [[nodiscard]] fs::path canonical(const fs::path& path) const;
+    [[nodiscard]] bool is_repository(const fs::path& directory) const;
+    [[nodiscard]] std::optional<std::string>
+    read_gitignore(const fs::path& directory) const;
+    void add_outer_filters(const fs::path& path, outer_levels& known);
+    [[nodiscard]] std::vector<explorer::root> discover(
+            std::span<const fs::path> roots, std::vector<fs::path>& nested
+    );
+    static void set_roots(explorer& explorer, std::span<const fs::path> roots);
+    [[nodiscard]] std::shared_ptr<const filter::ignore>
+    inherit(filter::ignore filter, bool is_root) const;
+    [[nodiscard]] std::shared_ptr<const filter::cone> read_cone(
+            const fs::path& path, const directory_reader& repository
+    ) const;
+    [[nodiscard]] std::shared_ptr<const filter::cone> narrow_cone(
+            const fs::path& path,
+            const directory_reader& directory,
+            bool is_root
+    ) const;
+    [[nodiscard]] directory_reader
+    open(const fs::path& path, const directory_reader& parent) const;
+    [[nodiscard]] bool claim(const file_id& id);
+    [[nodiscard]] std::shared_ptr<explorer::listing>
+    load(const fs::path& path, const directory_reader& parent);
+    [[nodiscard]] std::shared_ptr<explorer::listing>
+    read(const fs::path& path, directory_reader directory, const file_id& id);
+    void populate(const fs::path& path, const directory_reader& parent);
     void recurse();
-    [[nodiscard]] bool filter_entry(const fs::directory_entry& entry) const;
-    void filter_and_sort();
+    void look_ahead();
+    void enter(const fs::path& path, const directory_reader& parent);
+    void stream();
+    void probe(
+            const directory_reader& directory,
+            std::span<const std::string> names,
+            explorer::table& table
+    );
+    void resolve(const directory_reader& directory, explorer::table& table);
+    // Filters used by a listing, with the others compiled out of the loop
+    template <bool Paths, bool Prune, bool Bounds, bool Partial>
+    struct static_filters {
+        static constexpr auto paths = Paths;
+        static constexpr auto prune = Prune;
+        static constexpr auto bounds = Bounds;
+        static constexpr auto partial = Partial;
+    };
+    [[nodiscard]] std::array<bool, 4>
+    filters_used(const explorer::listing& listing) const noexcept;
+    template <bool... Known, typename Visit>
+    decltype(auto)
+    with_filters(std::span<const bool> used, const Visit& visit) const;
+
+    template <typename Filters>
+    [[nodiscard]] bool filter_entry(
+            const explorer::listing& listing,
+            const explorer::item& item,
+            std::string& path
+    ) const;
+    template <typename Filters>
+    void collect(
+            const explorer::listing& listing, std::vector<sort_key>& keys
+    ) const;
+    void filter_and_sort(explorer::listing& listing) const;
+    void start(const explorer::root& root);
+    void
+    start_next(const std::vector<explorer::root>& roots, std::size_t& next);
     void next();
+    template <typename Visit>
+    std::size_t drain(std::size_t limit, const Visit& visit);
+    void prefetch_remaining(std::span<const explorer::root> roots);
+    void resume(
+            const explorer::root& root, std::span<const saved_level> levels
+    );
 };
 
 namespace {
 
-auto getline(std::ifstream& input, std::string& s) {
-    if (!std::getline(input, s, '\n')) {
-        return false;
-    }
-    if (!s.empty() && s.back() == '\r') {
-        s.pop_back();
-    }
-    return true;
-}
+const auto dot_git = fs::path{ ".git" };
+const auto dot_gitignore = fs::path{ ".gitignore" };
 
-auto read_lines(const fs::path& path) {
-    auto stream = std::ifstream{ path };
-    auto lines = std::vector<std::string>{};
-    auto line = std::string{};
-    while (getline(stream, line)) {
-        lines.emplace_back(std::move(line));
+auto split_lines(std::string_view contents) {
+    auto lines = std::vector<std::string_view>{};
+    while (!contents.empty()) {
+        const auto end = std::min(contents.find('\n'), contents.size());
+        auto line = contents.substr(0, end);
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        lines.emplace_back(line);
+        contents.remove_prefix(std::min(end + 1, contents.size()));
     }
     return lines;
 }
 
-filter::ignore make_filter(const fs::path& path) {
+auto read_file(const fs::path& path) {
+    auto stream = std::ifstream{ path, std::ios::binary };
+    return std::string{ std::istreambuf_iterator<char>{ stream }, {} };
+}
+
+filter::ignore make_filter(std::string_view contents, const fs::path& path) {
     auto globs = std::vector<glob::decomposition>{};
-    auto lines = read_lines(path);
-    for (const auto& line : lines) {
+    for (const auto& line : split_lines(contents)) {
         globs.emplace_back(glob::decompose(line));
         if (globs.back().pattern.empty()) {
             globs.pop_back();
@@ -75,6 +313,250 @@ filter::ignore make_filter(const fs::path& path) {
     return { globs, path.parent_path() };
 }
 
+// Bounds are checked against metadata read along with directories
+explorer_options with_implied(explorer_options options) {
+    options.metadata = options.metadata || !options.bounds.empty();
+    return options;
+}
+
+auto trim(std::string_view text) {
+    const auto is_space = [](char c) { return c == ' ' || c == '\t'; };
+    while (!text.empty() && is_space(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && is_space(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+auto to_lower(std::string_view text) {
+    auto result = std::string{ text };
+    std::ranges::transform(result, result.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return result;
+}
+
+// Last value of boolean `section.key` in git config, without includes,
+// where both are given in lower case
+std::optional<bool> config_flag(
+        std::string_view config, std::string_view section, std::string_view key
+) {
+    auto current = std::string{};
+    auto result = std::optional<bool>{};
+    for (const auto& raw : split_lines(config)) {
+        const auto line = trim(raw);
+        if (line.starts_with('[')) {
+            current = to_lower(trim(line.substr(1, line.find(']') - 1)));
+            continue;
+        }
+        const auto equals = line.find('=');
+        if (current != section
+            || to_lower(trim(line.substr(0, equals))) != key) {
+            continue;
+        }
+        // Bare key means true
+        const auto value = equals != std::string_view::npos
+                ? to_lower(trim(line.substr(equals + 1)))
+                : std::string{ "true" };
+        result = value == "true" || value == "yes" || value == "on"
+                || value == "1";
+    }
+    return result;
+}
+
+// First line of file holding a single value, such as `.git` file of
+// worktrees and submodules, or `commondir` of worktrees
+std::string read_line(const directory_reader& directory, const fs::path& name) {
+    const auto contents = directory.read(name);
+    const auto lines = split_lines(contents);
+    return lines.empty() ? std::string{} : std::string{ trim(lines.front()) };
+}
+
+// Cone of sparse checkout in git directory, using `config` shared by all
+// worktrees, null if all of it is checked out or patterns are not a cone
+std::shared_ptr<const filter::cone>
+parse_cone(const directory_reader& git, std::string_view config) {
+    // Set by `git sparse-checkout` if the repository has several worktrees
+    const auto worktree = config_flag(config, "extensions", "worktreeconfig")
+                    .value_or(false)
+            ? git.read("config.worktree")
+            : std::string{};
+    const auto flag = [&config, &worktree](std::string_view key) {
+        return config_flag(worktree, "core", key)
+                .value_or(config_flag(config, "core", key).value_or(false));
+    };
+    if (!flag("sparsecheckout") || !flag("sparsecheckoutcone")
+        || git.type("info") != fs::file_type::directory) {
+        return nullptr;
+    }
+    const auto info = directory_reader{ git, "info" };
+    auto cone = filter::cone::parse(info.read("sparse-checkout"));
+    if (!cone || cone->is_recursive()) {
+        return nullptr;
+    }
+    return std::make_shared<const filter::cone>(std::move(*cone));
+}
+
+auto make_prefix(const fs::path& path) {
+    auto prefix = path.generic_string();
+    if (!prefix.ends_with('/')) {
+        prefix += '/';
+    }
+    return prefix;
+}
+
+// Checkpoints store sizes as varints and paths as UTF-8, so that they do not
+// depend on platform
+constexpr auto checkpoint_version = char{ 2 };
+
+// Flags of a level stored in checkpoint
+constexpr auto front_is_directory = char{ 1 };
+constexpr auto level_pruned = char{ 2 };
+
+void put_number(std::string& blob, std::uint64_t number) {
+    do {
+        const auto low = static_cast<unsigned char>(number & 0x7F);
+        number >>= 7;
+        blob += static_cast<char>(number != 0 ? low | 0x80 : low);
+    } while (number != 0);
+}
+
+void put_path(std::string& blob, const fs::path& path) {
+    const auto utf8 = path.u8string();
+    put_number(blob, utf8.size());
+    blob.append(utf8.begin(), utf8.end());
+}
+
+struct checkpoint_reader {
+    std::string_view blob{};
+
+    void require(std::size_t size) const {
+        if (blob.size() < size) {
+            throw std::invalid_argument{ "Truncated explorer checkpoint" };
+        }
+    }
+
+    char byte() {
+        require(1);
+        const auto result = blob.front();
+        blob.remove_prefix(1);
+        return result;
+    }
+
+    std::uint64_t number() {
+        auto result = std::uint64_t{};
+        for (auto shift = 0;; shift += 7) {
+            const auto next = static_cast<unsigned char>(byte());
+            if (shift >= std::numeric_limits<std::uint64_t>::digits) {
+                throw std::invalid_argument{ "Malformed explorer checkpoint" };
+            }
+            result |= static_cast<std::uint64_t>(next & 0x7F) << shift;
+            if ((next & 0x80) == 0) {
+                return result;
+            }
+        }
+    }
+
+    std::size_t size() {
+        const auto result = number();
+        // Every element takes at least a byte, which also bounds allocation
+        require(result);
+        return static_cast<std::size_t>(result);
+    }
+
+    fs::path path() {
+        const auto length = size();
+        require(length);
+        auto utf8 = std::u8string(length, u8'\0');
+        std::ranges::copy(blob.substr(0, length), utf8.begin());
+        blob.remove_prefix(length);
+        return utf8;
+    }
+};
+
+// FNV-1a of name in UTF-8, as shards must agree across processes and
+// platforms, unlike with `std::hash`. Continues from `hash` of the path
+// before it, so that path is hashed one name at a time.
+std::uint64_t
+stable_hash(name_view name, std::uint64_t hash = 0xcbf29ce484222325) {
+    const auto mix = [&hash](auto byte) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= std::uint64_t{ 0x100000001b3 };
+    };
+    if constexpr (std::is_same_v<fs::path::value_type, char>) {
+        std::ranges::for_each(name, mix);
+    } else {
+        std::ranges::for_each(fs::path{ name }.u8string(), mix);
+    }
+    return hash;
+}
+
+void append_name(std::string& path, name_view name) {
+    if constexpr (std::is_same_v<fs::path::value_type, char>) {
+        path += name;
+    } else {
+        path += fs::path{ name }.string();
+    }
+}
+
+const filter::cone*
+find_subdirectory(const filter::cone& cone, name_view name) {
+    if constexpr (std::is_same_v<fs::path::value_type, char>) {
+        return cone.subdirectory(name);
+    } else {
+        return cone.subdirectory(fs::path{ name }.string());
+    }
+}
+
+// Checks listings of levels from the innermost, up through their parents
+bool any_level(const auto* level, const auto& predicate) {
+    for (; level != nullptr; level = level->parent.get()) {
+        if (predicate(*level->contents)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Suspends coroutine while blocking work runs on executor. Whichever finishes
+// second of `await_suspend` and the work continues the coroutine, so that
+// executors running work inline do not resume it from within itself.
+class offload {
+    public:
+    offload(const executor& submit, std::function<void()> work) :
+        submit{ submit },
+        work{ std::move(work) } {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> coroutine) {
+        submit([this, coroutine] {
+            try {
+                work();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            if (finished.exchange(true, std::memory_order_acq_rel)) {
+                coroutine.resume();
+            }
+        });
+        return !finished.exchange(true, std::memory_order_acq_rel);
+    }
+    void await_resume() const {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    private:
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    const executor& submit;
+    std::function<void()> work;
+    std::exception_ptr error{};
+    std::atomic<bool> finished{};
+};
+
 auto is_root(const fs::path& path) {
 #if defined(UNIT_TEST)
     if (path.parent_path() == fs::canonical(fs::temp_directory_path())) {
@@ -88,172 +570,1581 @@ auto is_root(const fs::path& path) {
 
 }  // namespace
 
-void explorer_impl::add_outer_filters(const fs::path& path) {
-    if (fs::is_directory(path / ".git")) {
+struct explorer::counters {
+    std::atomic<std::size_t> entries{};
+    std::atomic<std::size_t> stats{};
+};
+
+explorer::table::table(std::pmr::memory_resource* resource) :
+    names(resource),
+    offsets(1, 0, resource),
+    types(resource),
+    sizes(resource),
+    times(resource) {}
+
+explorer::table::table(
+        const table& other, std::pmr::memory_resource* resource
+) :
+    names(other.names, resource),
+    offsets(other.offsets, resource),
+    types(other.types, resource),
+    sizes(other.sizes, resource),
+    times(other.times, resource) {}
+
+explorer::item explorer::table::operator[](std::size_t index) const noexcept {
+    const auto begin = offsets[index];
+    const auto length = offsets[index + 1] - begin - 1;
+    return {
+        .name = name_view{ names }.substr(begin, length),
+        .type = types[index],
+        .size = sizes.empty() ? 0 : sizes[index],
+        .last_write_time = times.empty() ? fs::file_time_type{} : times[index],
+    };
+}
+
+const fs::path::value_type*
+explorer::table::c_str(std::size_t index) const noexcept {
+    return names.data() + offsets[index];
+}
+
+std::size_t explorer::table::footprint() const noexcept {
+    // Each array may need padding to be aligned within arena
+    static constexpr auto padding = alignof(std::max_align_t);
+    return (names.size() + 1) * sizeof(fs::path::value_type)
+            + offsets.size() * sizeof(std::uint32_t)
+            + types.size() * sizeof(fs::file_type)
+            + sizes.size() * sizeof(std::uintmax_t)
+            + times.size() * sizeof(fs::file_time_type) + 5 * padding;
+}
+
+void explorer::table::append(name_view name, fs::file_type type) {
+    names += name;
+    names += fs::path::value_type{};
+    offsets.push_back(static_cast<std::uint32_t>(names.size()));
+    types.push_back(type);
+}
+
+void explorer::table::clear() noexcept {
+    names.clear();
+    offsets.resize(1);
+    types.clear();
+    sizes.clear();
+    times.clear();
+}
+
+// Reads directories on worker threads, in the same way as `explorer_impl::load`
+// would on the consumer thread. Each directory is keyed by its path until
+// `take`n by the consumer, which then descends into it in the usual order.
+// Without lookahead, subdirectories are scheduled as soon as their parent is
+// read, before it is handed to the consumer, so that the consumer never misses
+// them. With lookahead, only the consumer schedules, see `look_ahead`.
+// Directories the consumer passes without taking are `discard`ed, along with
+// everything scheduled below them, so that nothing is kept until destruction.
+struct explorer::prefetcher {
+    using result = std::shared_ptr<const explorer::listing>;
+
+    // Result of directories left for the consumer to read, as workers found
+    // them already claimed through another path
+    static inline const auto unread
+            = std::make_shared<const explorer::listing>();
+
+    prefetcher(
+            const explorer_options& options,
+            std::shared_ptr<explorer::counters> counts
+    ) :
+        options{ options },
+        counts{ std::move(counts) },
+        pool{ std::max<std::size_t>(options.threads, 1) } {}
+
+    void schedule(
+            const fs::path& path, std::shared_ptr<explorer::level> parents
+    );
+    void schedule_subdirectories(
+            result listing, std::shared_ptr<explorer::level> parents
+    );
+    [[nodiscard]] std::future<result> take(const fs::path& path);
+    [[nodiscard]] bool contains(const fs::path& path);
+    void discard(const explorer::listing& listing);
+    [[nodiscard]] bool claim(const file_id& id);
+    [[nodiscard]] bool reads_below(
+            const explorer::listing& listing, const explorer::level* parents
+    ) const noexcept;
+
+    // Set before anything is scheduled, see `explorer::nested_roots`
+    std::shared_ptr<const std::vector<fs::path>> nested_roots{};
+
+    private:
+    // Workers stop scheduling subdirectories once this many directories are
+    // pending, so that reading ahead without lookahead cannot hold the whole
+    // tree. The consumer reads the rest itself, scheduling below them again.
+    static constexpr auto read_ahead_limit = std::size_t{ 1024 };
+
+    // Shared with the worker reading the directory, guarded by `mutex`
+    struct progress {
+        bool started{};
+        bool discarded{};
+        // Listing whose subdirectories the worker scheduled, if any
+        result scheduled{};
+    };
+    struct task {
+        std::future<result> future{};
+        std::shared_ptr<progress> state{};
+    };
+    using job = std::function<void()>;
+
+    [[nodiscard]] job
+    schedule_locked(fs::path path, std::shared_ptr<explorer::level> parents);
+    void schedule_subdirectories(
+            result listing,
+            std::shared_ptr<explorer::level> parents,
+            progress* owner
+    );
+    void discard_locked(const explorer::listing& listing);
+    void run(
+            const fs::path& path,
+            std::shared_ptr<explorer::level>& parents,
+            std::promise<result>& promise,
+            progress& state
+    );
+
+    explorer_options options{};
+    std::shared_ptr<explorer::counters> counts{};
+    std::mutex mutex{};
+    std::unordered_map<fs::path, task, path_hash> pending{};
+    // Directories read by workers when following symlinks, claimed before
+    // reading, so that those reached by several paths are only read once
+    std::unordered_set<file_id> claimed{};
+    // Declared last to join workers before the members they use are destroyed
+    glug::detail::thread_pool pool;
+};
+
+void explorer::prefetcher::schedule(
+        const fs::path& path, std::shared_ptr<explorer::level> parents
+) {
+    auto work = job{};
+    {
+        const auto lock = std::scoped_lock{ mutex };
+        work = schedule_locked(path, std::move(parents));
+    }
+    pool.submit(std::move(work));
+}
+
+explorer::prefetcher::job explorer::prefetcher::schedule_locked(
+        fs::path path, std::shared_ptr<explorer::level> parents
+) {
+    // `std::function` requires copyable callables, unlike `std::promise`
+    auto promise = std::make_shared<std::promise<result>>();
+    auto state = std::make_shared<progress>();
+    auto& pending_task = pending[path];
+    if (pending_task.state) {
+        pending_task.state->discarded = true;
+        if (pending_task.state->scheduled) {
+            discard_locked(*pending_task.state->scheduled);
+        }
+    }
+    pending_task = { .future = promise->get_future(), .state = state };
+    return [this,
+            path = std::move(path),
+            parents = std::move(parents),
+            promise,
+            state]() mutable { run(path, parents, *promise, *state); };
+}
+
+// Reads not started yet are claimed back, for the caller to read inline
+// instead of waiting for them behind reads further ahead
+std::future<explorer::prefetcher::result>
+explorer::prefetcher::take(const fs::path& path) {
+    const auto lock = std::scoped_lock{ mutex };
+    auto node = pending.extract(path);
+    if (node.empty()) {
+        return {};
+    }
+    auto& [future, state] = node.mapped();
+    if (!state->started) {
+        state->discarded = true;
+        return {};
+    }
+    return std::move(future);
+}
+
+void explorer::prefetcher::schedule_subdirectories(
+        result listing, std::shared_ptr<explorer::level> parents
+) {
+    schedule_subdirectories(std::move(listing), std::move(parents), nullptr);
+}
+
+void explorer::prefetcher::schedule_subdirectories(
+        result listing, std::shared_ptr<explorer::level> parents, progress* owner
+) {
+    const auto level = std::make_shared<explorer::level>(explorer::level{
+        .contents = listing,
+        .parent = std::move(parents),
+    });
+    auto jobs = std::vector<job>{};
+    {
+        // Checked together with scheduling, so that a concurrent `discard`
+        // either sees the subdirectories or stops them from being scheduled
+        const auto lock = std::scoped_lock{ mutex };
+        if (owner != nullptr) {
+            if (owner->discarded) {
+                return;
+            }
+            owner->scheduled = listing;
+        }
+        // Directories follow files, and only the nearest of them fit when
+        // over the limit. Scheduled in reverse, so that the nearest run first.
+        const auto is_file = [&listing](auto index) {
+            return listing->entries.types[index] != fs::file_type::directory;
+        };
+        const auto order = std::span{ listing->order };
+        const auto first = std::ranges::partition_point(order, is_file);
+        const auto directories = static_cast<std::size_t>(order.end() - first);
+        const auto slots = owner == nullptr
+                ? directories
+                : read_ahead_limit - std::min(pending.size(), read_ahead_limit);
+        const auto nearest = order.subspan(
+                order.size() - directories, std::min(slots, directories)
+        );
+        for (const auto index : std::ranges::reverse_view(nearest)) {
+            const auto item = listing->entries[index];
+            jobs.push_back(schedule_locked(listing->path / item.name, level));
+        }
+    }
+    for (auto& work : jobs) {
+        pool.submit(std::move(work));
+    }
+}
+
+// Nested repositories share no rules with the rest of the walk, so they are
+// read ahead in full like everything is without lookahead
+bool explorer::prefetcher::reads_below(
+        const explorer::listing& listing, const explorer::level* parents
+) const noexcept {
+    const auto is_nested = std::mem_fn(&explorer::listing::is_nested);
+    return options.lookahead == 0 || listing.is_nested
+            || any_level(parents, is_nested);
+}
+
+bool explorer::prefetcher::claim(const file_id& id) {
+    const auto lock = std::scoped_lock{ mutex };
+    return claimed.insert(id).second;
+}
+
+bool explorer::prefetcher::contains(const fs::path& path) {
+    const auto lock = std::scoped_lock{ mutex };
+    return pending.contains(path);
+}
+
+void explorer::prefetcher::discard(const explorer::listing& listing) {
+    const auto lock = std::scoped_lock{ mutex };
+    if (!pending.empty()) {
+        discard_locked(listing);
+    }
+}
+
+void explorer::prefetcher::discard_locked(const explorer::listing& listing) {
+    // Subdirectories already taken are no longer pending, and so are kept
+    for (const auto index : std::ranges::reverse_view(listing.order)) {
+        const auto item = listing.entries[index];
+        if (item.type != fs::file_type::directory) {
+            break;
+        }
+        auto node = pending.extract(listing.path / item.name);
+        if (node.empty()) {
+            continue;
+        }
+        auto& state = *node.mapped().state;
+        state.discarded = true;
+        if (state.scheduled) {
+            discard_locked(*state.scheduled);
+        }
+    }
+}
+
+void explorer::prefetcher::run(
+        const fs::path& path,
+        std::shared_ptr<explorer::level>& parents,
+        std::promise<result>& promise,
+        progress& state
+) {
+    try {
+        {
+            const auto lock = std::scoped_lock{ mutex };
+            if (state.discarded) {
+                promise.set_value(nullptr);
+                return;
+            }
+            state.started = true;
+        }
+        auto impl = explorer_impl{
+            .top = parents,
+            .options = options,
+            .counts = *counts,
+            .nested_roots = nested_roots ? std::span{ *nested_roots }
+                                         : std::span<const fs::path>{},
+        };
+        auto directory = impl.open(path, {});
+        const auto id = options.follow_symlinks ? directory.id() : file_id{};
+        if (!impl.claim(id)) {
+            promise.set_value(nullptr);
+            return;
+        }
+        // Only the consumer knows which path is walked first, so it gets the
+        // rest, usually just to reject them without reading
+        if (options.follow_symlinks && !claim(id)) {
+            promise.set_value(unread);
+            return;
+        }
+        auto listing = impl.read(path, std::move(directory), id);
+        if (!listing) {
+            promise.set_value(nullptr);
+            return;
+        }
+
+        // Waiting listings would otherwise exhaust descriptors on large trees
+        listing->directory.close();
+        if (reads_below(*listing, parents.get())) {
+            schedule_subdirectories(listing, parents, &state);
+        }
+        promise.set_value(std::move(listing));
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+explorer::item explorer_impl::front(const explorer::level& level) noexcept {
+    if (!level.streamed.empty()) {
+        return level.streamed[0];
+    }
+    const auto& contents = *level.contents;
+    return contents.entries[contents.order[level.position]];
+}
+
+bool explorer_impl::exhausted(const explorer::level& level) noexcept {
+    const auto& contents = *level.contents;
+    if (level.position >= contents.order.size()) {
+        return true;
+    }
+    // Directories are sorted last, so once pruned, only those remain
+    const auto index = contents.order[level.position];
+    return level.pruned
+            && contents.entries.types[index] == fs::file_type::directory;
+}
+
+// Called before the listing of directory is pushed, so `top` is its parent
+bool explorer_impl::is_walk_root() const noexcept {
+    // Levels above roots only hold rules, without a path
+    return !top || top->contents->path.empty();
+}
+
+// Also called before push, so `top` is the parent of listing
+void explorer_impl::shard(explorer::listing& listing) const {
+    if (options.shard.count <= 1) {
+        return;
+    }
+    if (is_walk_root()) {
+        listing.is_sharded = true;
+        listing.shard_hash = stable_hash({});
+        return;
+    }
+    const auto& parent = *top->contents;
+    if (!parent.is_sharded || parent.shard_depth + 1 >= options.shard.depth) {
+        return;
+    }
+    listing.is_sharded = true;
+    listing.shard_depth = parent.shard_depth + 1;
+    // Separated, so that `a/bc` and `ab/c` differ
+    static constexpr auto slash = fs::path::value_type{ '/' };
+    const auto name = listing.path.filename();
+    listing.shard_hash = stable_hash(
+            name_view{ &slash, 1 },
+            stable_hash(name.native(), parent.shard_hash)
+    );
+}
+
+void explorer_impl::push(listing_ptr listing) {
+    top = std::make_shared<explorer::level>(explorer::level{
+        .contents = std::move(listing),
+        .parent = std::move(top),
+    });
+}
+
+void explorer_impl::unwind() {
+    while (top && exhausted(*top)) {
+        // Subdirectories not taken by now were pruned or rejected
+        if (prefetch != nullptr && !top->contents->path.empty()) {
+            prefetch->discard(*top->contents);
+        }
+        top = top->parent;
+    }
+}
+
+explorer::level& explorer_impl::own() {
+    // Copy on write, as copies of explorer or workers may hold the same level
+    if (top.use_count() > 1) {
+        top = std::make_shared<explorer::level>(*top);
+    }
+    return *top;
+}
+
+explorer_impl explorer_impl::of(explorer& explorer) {
+    return {
+        .top = explorer.top,
+        .options = *explorer.options,
+        .counts = *explorer.counts,
+        .prefetch = explorer.prefetch.get(),
+        .visited = &explorer.visited,
+        .nested_roots = explorer.nested_roots
+                ? std::span{ *explorer.nested_roots }
+                : std::span<const fs::path>{},
+    };
+}
+
+void explorer_impl::prepare(
+        explorer& explorer, const explorer_options& requested
+) {
+    const auto options = with_implied(requested);
+    explorer.options = std::make_shared<const explorer_options>(options);
+    explorer.counts = std::make_shared<explorer::counters>();
+    if ((options.threads > 1 || options.lookahead > 0) && !options.unordered) {
+        explorer.prefetch = std::make_shared<explorer::prefetcher>(
+                options, explorer.counts
+        );
+    }
+    if (options.follow_symlinks) {
+        explorer.visited = std::make_shared<std::unordered_set<file_id>>();
+    }
+}
+
+fs::path explorer_impl::canonical(const fs::path& path) const {
+    return options.source ? options.source->canonical(path)
+                          : fs::canonical(path);
+}
+
+bool explorer_impl::is_repository(const fs::path& directory) const {
+    if (options.source) {
+        const auto reader = options.source->open(directory);
+        return reader.type(dot_git) == fs::file_type::directory;
+    }
+    return fs::is_directory(directory / dot_git);
+}
+
+std::optional<std::string>
+explorer_impl::read_gitignore(const fs::path& directory) const {
+    if (options.source) {
+        const auto reader = options.source->open(directory);
+        if (reader.type(dot_gitignore) != fs::file_type::regular) {
+            return std::nullopt;
+        }
+        return reader.read(dot_gitignore);
+    }
+    const auto path = directory / dot_gitignore;
+    if (!fs::is_regular_file(path)) {
+        return std::nullopt;
+    }
+    return read_file(path);
+}
+
+void explorer_impl::add_outer_filters(
+        const fs::path& path, outer_levels& known
+) {
+    top = nullptr;
+    if (is_repository(path)) {
         return;
     }
 
-    auto current = fs::canonical(path);
+    // Walk up until repository root, or until directory walked for another
+    // root, whose levels are then shared
+    auto directories = std::vector<fs::path>{};
+    auto current = canonical(path);
     while (!is_root(current)) {
         current = current.parent_path();
-        const auto gitignore = current / ".gitignore";
-        const auto has_gitignore = fs::is_regular_file(gitignore);
-        const auto is_root = fs::is_directory(current / ".git");
-        if (!has_gitignore && !is_root) {
-            continue;
+        if (const auto found = known.find(current); found != known.end()) {
+            top = found->second;
+            break;
         }
+        directories.push_back(current);
+        if (is_repository(current)) {
+            break;
+        }
+    }
 
-        auto filter = has_gitignore ? make_filter(gitignore) : filter::ignore{};
-        stack.emplace_back(
-                std::move(filter),
-                std::deque<std::filesystem::directory_entry>{},
+    for (auto& directory : std::ranges::reverse_view(directories)) {
+        const auto gitignore = read_gitignore(directory);
+        const auto is_root = is_repository(directory);
+        // Levels also carry cone down to the root, whenever it narrows
+        auto cone = narrow_cone(
+                directory,
+                is_root ? open(directory, {}) : directory_reader{},
                 is_root
         );
-        if (is_root) {
-            break;
+        const auto* inherited = top ? top->contents->cone.get() : nullptr;
+        if (gitignore || is_root || cone.get() != inherited) {
+            auto filter = gitignore
+                    ? make_filter(*gitignore, directory / dot_gitignore)
+                    : filter::ignore{};
+            push(std::make_shared<const explorer::listing>(explorer::listing{
+                .filter = inherit(std::move(filter), is_root),
+                .cone = std::move(cone),
+                .is_root = is_root,
+            }));
         }
+        known.emplace(std::move(directory), top);
     }
-    std::ranges::reverse(stack);
-};
+}
 
-void explorer_impl::populate(const fs::path& path) {
-    auto entries = std::deque<fs::directory_entry>{
-        fs::directory_iterator{ path },
-        fs::directory_iterator{},
+std::vector<explorer::root> explorer_impl::discover(
+        std::span<const fs::path> roots, std::vector<fs::path>& nested
+) {
+    auto canonical = std::vector<fs::path>{};
+    canonical.reserve(roots.size());
+    std::ranges::transform(
+            roots,
+            std::back_inserter(canonical),
+            [this](const auto& root) { return this->canonical(root); }
+    );
+    const auto is_within = [](const fs::path& path, const fs::path& outer) {
+        return std::ranges::mismatch(outer, path).in1 == outer.end();
     };
-    if (entries.empty()) {
+
+    const auto indices = std::views::iota(std::size_t{}, roots.size());
+    auto known = outer_levels{};
+    auto result = std::vector<explorer::root>{};
+    for (const auto i : indices) {
+        // Keep only first of repeated roots
+        const auto is_repeated = [&](std::size_t j) {
+            return j < i && canonical[i] == canonical[j];
+        };
+        if (std::ranges::any_of(indices, is_repeated)) {
+            continue;
+        }
+        // Nested roots are walked on their own, even if ignored or a nested
+        // repository, so walks of outer roots skip them if they get there
+        for (const auto j : indices) {
+            if (canonical[i] != canonical[j]
+                && is_within(canonical[i], canonical[j])) {
+                nested.push_back(
+                        roots[j]
+                        / canonical[i].lexically_relative(canonical[j])
+                );
+            }
+        }
+        add_outer_filters(roots[i], known);
+        result.push_back({ .path = roots[i], .outer = std::move(top) });
+    }
+    top = nullptr;
+    return result;
+}
+
+void explorer_impl::set_roots(
+        explorer& explorer, std::span<const fs::path> roots
+) {
+    auto nested = std::vector<fs::path>{};
+    explorer.roots = std::make_shared<const std::vector<explorer::root>>(
+            of(explorer).discover(roots, nested)
+    );
+    if (nested.empty()) {
         return;
     }
+    explorer.nested_roots
+            = std::make_shared<const std::vector<fs::path>>(std::move(nested));
+    if (explorer.prefetch) {
+        explorer.prefetch->nested_roots = explorer.nested_roots;
+    }
+}
 
-    const auto is_named = [](const auto& filename) {
-        return [&filename](const auto& entry) {
-            return entry.path().filename() == filename;
-        };
+std::shared_ptr<const filter::ignore>
+explorer_impl::inherit(filter::ignore filter, bool is_root) const {
+    // Chain of filters ends at repository root
+    auto parent = top && !is_root ? top->contents->filter : nullptr;
+    if (filter.empty()) {
+        return parent;
+    }
+    if (!parent) {
+        return std::make_shared<const filter::ignore>(std::move(filter));
+    }
+    return std::make_shared<const filter::ignore>(*parent, filter);
+}
+
+// Git directory may be elsewhere, as given by `.git` file of worktrees and
+// submodules, and worktrees share config in `commondir` of main repository
+std::shared_ptr<const filter::cone> explorer_impl::read_cone(
+        const fs::path& path, const directory_reader& repository
+) const {
+    try {
+        auto git_path = path / dot_git;
+        auto git = directory_reader{};
+        const auto type = repository.type(dot_git);
+        if (type == fs::file_type::directory) {
+            git = directory_reader{ repository, dot_git };
+        } else if (type == fs::file_type::regular) {
+            static constexpr auto prefix = std::string_view{ "gitdir:" };
+            const auto link = read_line(repository, dot_git);
+            if (!link.starts_with(prefix)) {
+                return nullptr;
+            }
+            // Relative to the directory holding `.git`
+            const auto target = fs::path{ trim(link.substr(prefix.size())) };
+            git_path = (path / target).lexically_normal();
+            git = open(git_path, {});
+        } else {
+            return nullptr;
+        }
+
+        const auto common = read_line(git, "commondir");
+        if (common.empty()) {
+            return parse_cone(git, git.read("config"));
+        }
+        const auto shared = open((git_path / common).lexically_normal(), {});
+        return parse_cone(git, shared.read("config"));
+    } catch (const fs::filesystem_error&) {
+        // Repository is walked in full if its git directory is missing
+        return nullptr;
+    }
+}
+
+std::shared_ptr<const filter::cone> explorer_impl::narrow_cone(
+        const fs::path& path, const directory_reader& directory, bool is_root
+) const {
+    if (is_root) {
+        return read_cone(path, directory);
+    }
+    auto parent = top ? top->contents->cone : nullptr;
+    if (!parent) {
+        return nullptr;
+    }
+    // Roots outside the cone are walked in full, as they were asked for
+    const auto* cone = find_subdirectory(*parent, path.filename().native());
+    if (cone == nullptr || cone->is_recursive()) {
+        return nullptr;
+    }
+    return { std::move(parent), cone };
+}
+
+directory_reader explorer_impl::open(
+        const fs::path& path, const directory_reader& parent
+) const {
+    if (!parent.is_open()) {
+        return options.source ? options.source->open(path)
+                              : directory_reader{ path };
+    }
+    return { parent, path.filename(), options.follow_symlinks };
+}
+
+bool explorer_impl::claim(const file_id& id) {
+    if (!options.follow_symlinks) {
+        return true;
+    }
+
+    // Ancestors are checked even without `visited` to stop loops on workers
+    const bool is_loop = any_level(top.get(), [&id](const auto& listing) {
+        return listing.id == id;
+    });
+    if (is_loop || visited == nullptr) {
+        return !is_loop;
+    }
+
+    auto& claimed = *visited;
+    if (claimed->contains(id)) {
+        return false;
+    }
+    // Copy on write, as copies of explorer walk the rest of tree separately
+    if (claimed.use_count() > 1) {
+        claimed = std::make_shared<std::unordered_set<file_id>>(*claimed);
+    }
+    claimed->insert(id);
+    return true;
+}
+
+std::shared_ptr<explorer::listing> explorer_impl::load(
+        const fs::path& path, const directory_reader& parent
+) {
+    auto directory = open(path, parent);
+    const auto id = options.follow_symlinks ? directory.id() : file_id{};
+    if (!claim(id)) {
+        return nullptr;
+    }
+    return read(path, std::move(directory), id);
+}
+
+std::shared_ptr<explorer::listing> explorer_impl::read(
+        const fs::path& path, directory_reader directory, const file_id& id
+) {
+    // Read into reused table first, to copy it into the arena at once
+    auto reused_scratch = reused<explorer::table>{};
+    auto& scratch = *reused_scratch;
+    scratch.clear();
+    const auto prefix = make_prefix(path);
+    const auto selected = options.select.subdirectories(
+            std::string_view{ prefix }.substr(0, prefix.size() - 1)
+    );
+    if (selected) {
+        probe(directory, *selected, scratch);
+    } else {
+        while (const auto raw = directory.next()) {
+            scratch.append(raw->name, raw->type);
+        }
+    }
+    if (scratch.empty()) {
+        return nullptr;
+    }
+    resolve(directory, scratch);
+
+    const auto contains = [&scratch](const fs::path& filename) {
+        const auto indices = std::views::iota(std::size_t{}, scratch.size());
+        return std::ranges::any_of(indices, [&scratch, &filename](auto index) {
+            return scratch[index].name == filename.native();
+        });
     };
-    const bool is_root = std::ranges::any_of(entries, is_named(".git"));
-    const bool already_rooted = std::ranges::any_of(
-            stack, std::mem_fn(&explorer::level::is_root)
+    const bool is_root = contains(dot_git);
+    const bool is_nested = is_root
+            && any_level(top.get(), std::mem_fn(&explorer::listing::is_root));
+    if (is_nested && !options.nested_repositories) {
+        return nullptr;
+    }
+
+    auto filter = contains(dot_gitignore)
+            ? make_filter(directory.read(dot_gitignore), path / dot_gitignore)
+            : filter::ignore{};
+    auto cone = narrow_cone(path, directory, is_root);
+    // Sized for the table and order of its entries, in a single buffer
+    auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(
+            scratch.footprint() + scratch.size() * sizeof(std::uint32_t),
+            options.memory_resource != nullptr
+                    ? options.memory_resource
+                    : std::pmr::get_default_resource()
     );
-    if (is_root && already_rooted) {
+    auto* const resource = arena.get();
+    auto listing = std::make_shared<explorer::listing>(explorer::listing{
+        .filter = inherit(std::move(filter), is_root),
+        .cone = std::move(cone),
+        .arena = std::move(arena),
+        .entries = explorer::table{ scratch, resource },
+        .order = std::pmr::vector<std::uint32_t>{ resource },
+        .is_root = is_root,
+        .is_nested = is_nested,
+        .path = path,
+        .prefix = prefix,
+        .directory = std::move(directory),
+        .id = id,
+    });
+    shard(*listing);
+    filter_and_sort(*listing);
+    return listing->order.empty() ? nullptr : listing;
+}
+
+void explorer_impl::populate(
+        const fs::path& path, const directory_reader& parent
+) {
+    auto prefetched = prefetch != nullptr
+            ? prefetch->take(path)
+            : std::future<explorer::prefetcher::result>{};
+    auto result = prefetched.valid() ? prefetched.get()
+                                     : explorer::prefetcher::unread;
+    auto listing = listing_ptr{};
+    if (result == explorer::prefetcher::unread) {
+        listing = load(path, parent);
+        // Read inline, so workers did not schedule below it either
+        if (listing && prefetch != nullptr
+            && prefetch->reads_below(*listing, top.get())) {
+            prefetch->schedule_subdirectories(listing, top);
+        }
+    } else if (result && claim(result->id)) {
+        listing = std::move(result);
+    } else if (result) {
+        prefetch->discard(*result);
+    }
+
+    if (listing) {
+        push(std::move(listing));
+        look_ahead();
+        recurse();
+    }
+}
+
+// Only selected subdirectories are queried, along with entries affecting
+// filters, instead of reading the whole directory
+void explorer_impl::probe(
+        const directory_reader& directory,
+        std::span<const std::string> names,
+        explorer::table& table
+) {
+    const auto add = [&](const fs::path& name) {
+        const auto type = directory.type(name);
+        if (type != fs::file_type::not_found) {
+            counts.stats.fetch_add(1, std::memory_order_relaxed);
+            table.append(name.native(), type);
+        }
+    };
+    add(dot_git);
+    add(dot_gitignore);
+    for (const auto& name : names) {
+        const auto path = fs::path{ name };
+        if (path != dot_git && path != dot_gitignore) {
+            add(path);
+        }
+    }
+}
+
+void explorer_impl::resolve(
+        const directory_reader& directory, explorer::table& table
+) {
+    // Reused to avoid allocating for every directory
+    auto reused_pending = reused<std::vector<std::size_t>>{};
+    auto reused_names = reused<std::vector<const fs::path::value_type*>>{};
+    auto& pending = *reused_pending;
+    auto& names = *reused_names;
+    pending.clear();
+    names.clear();
+    counts.entries.fetch_add(table.size(), std::memory_order_relaxed);
+    for (auto i = std::size_t{}; i < table.size(); i++) {
+        const auto type = table.types[i];
+        // GCOVR_EXCL_START: Only some filesystems do not report types
+        const bool is_unknown = type == fs::file_type::unknown;
+        // GCOVR_EXCL_STOP
+        const bool is_file = type == fs::file_type::regular;
+        const bool is_symlink = type == fs::file_type::symlink;
+        if (is_unknown || (options.metadata && is_file)
+            || (options.follow_symlinks && is_symlink)) {
+            pending.push_back(i);
+            names.push_back(table.c_str(i));
+        }
+    }
+    if (options.metadata) {
+        table.sizes.resize(table.size());
+        table.times.resize(table.size());
+    }
+    if (pending.empty()) {
         return;
     }
 
-    const auto gitignore
-            = std::ranges::find_if(entries, is_named(".gitignore"));
-    auto filter = gitignore != entries.end() ? make_filter(gitignore->path())
-                                             : filter::ignore{};
-    stack.emplace_back(std::move(filter), std::move(entries), is_root);
-    filter_and_sort();
+    counts.stats.fetch_add(pending.size(), std::memory_order_relaxed);
+    const auto statuses = directory.status(names, options.follow_symlinks);
+    for (auto i = std::size_t{}; i < pending.size(); i++) {
+        table.types[pending[i]] = statuses[i].type;
+        if (options.metadata) {
+            table.sizes[pending[i]] = statuses[i].size;
+            table.times[pending[i]] = statuses[i].last_write_time;
+        }
+    }
 }
 
-bool explorer_impl::filter_entry(const fs::directory_entry& entry) const {
+template <typename Filters>
+bool explorer_impl::filter_entry(
+        const explorer::listing& listing,
+        const explorer::item& item,
+        std::string& path
+) const {
     // GCOVR_EXCL_START: Special file types not testable on all OS
-    // `is_directory() || is_file()` returns value for symlink target
-    if (entry.is_symlink()) {
+    if (item.type == fs::file_type::symlink) {
         return true;
     }
 
-    if (!entry.is_directory() && !entry.is_regular_file()) {
+    const bool is_directory = item.type == fs::file_type::directory;
+    if (!is_directory && item.type != fs::file_type::regular) {
         return true;
     }
     // GCOVR_EXCL_STOP
 
-    if (entry.path().filename() == ".git") {
+    if (Filters::bounds && !is_directory
+        && !options.bounds.contains(item.size, item.last_write_time)) {
         return true;
     }
 
-    if (options.select(entry) == filter::decision::excluded) {
+    if (item.name == dot_git.native()) {
         return true;
     }
 
-    for (const auto& level : std::ranges::reverse_view(stack)) {
-        const auto decision = level.filter(entry);
-        if (level.is_root || decision != filter::decision::undecided) {
-            return decision == filter::decision::excluded;
+    if constexpr (Filters::partial) {
+        if (is_directory && listing.cone
+            && find_subdirectory(*listing.cone, item.name) == nullptr) {
+            return true;
+        }
+
+        // Directories above shard depth are read by every shard
+        const auto& shard = options.shard;
+        if (listing.is_sharded && shard.count > 1
+            && (!is_directory || listing.shard_depth + 1 >= shard.depth)
+            && stable_hash(item.name, listing.shard_hash) % shard.count
+                    != shard.index) {
+            return true;
+        }
+
+        if (is_directory && !nested_roots.empty()
+            && std::ranges::find(nested_roots, listing.path / item.name)
+                    != nested_roots.end()) {
+            return true;
         }
     }
-    return false;
+
+    // Path for filters is only built if there are any
+    if constexpr (Filters::paths) {
+        // Buffer of caller, to avoid allocating a path for every entry
+        path = listing.prefix;
+        append_name(path, item.name);
+
+        if (options.select.apply(path, is_directory)
+            == filter::decision::excluded) {
+            return true;
+        }
+        if (is_directory && !options.select.may_contain(path)) {
+            return true;
+        }
+        if (listing.filter
+            && listing.filter->apply(path, is_directory)
+                    == filter::decision::excluded) {
+            return true;
+        }
+    }
+
+    return Filters::prune && is_directory
+            && options.prune(listing.path / item.name);
 };
 
-void explorer_impl::filter_and_sort() {
-    auto& entries = stack.back().entries;
-    std::erase_if(entries, [this](const auto& entry) {
-        return filter_entry(entry);
+template <typename Filters>
+void explorer_impl::collect(
+        const explorer::listing& listing, std::vector<sort_key>& keys
+) const {
+    const auto& entries = listing.entries;
+    auto path = reused<std::string>{};
+    for (auto i = std::uint32_t{}; i < entries.size(); i++) {
+        if (!filter_entry<Filters>(listing, entries[i], *path)) {
+            const auto begin = entries.offsets[i];
+            keys.push_back({
+                    .name = entries.c_str(i),
+                    .length = entries.offsets[i + 1] - begin - 1,
+                    .index = i,
+            });
+        }
+    }
+}
+
+std::array<bool, 4>
+explorer_impl::filters_used(const explorer::listing& listing) const noexcept {
+    return {
+        !options.select.empty() || listing.filter != nullptr,
+        static_cast<bool>(options.prune),
+        !options.bounds.empty(),
+        listing.cone != nullptr
+                || (listing.is_sharded && options.shard.count > 1)
+                || !nested_roots.empty(),
+    };
+}
+
+// Picks the instantiation for filters used by the listing, one flag at a time
+template <bool... Known, typename Visit>
+decltype(auto) explorer_impl::with_filters(
+        std::span<const bool> used, const Visit& visit
+) const {
+    if constexpr (sizeof...(Known) == 4) {
+        return visit(static_filters<Known...>{});
+    } else if (used[sizeof...(Known)]) {
+        return with_filters<Known..., true>(used, visit);
+    } else {
+        return with_filters<Known..., false>(used, visit);
+    }
+}
+
+void explorer_impl::filter_and_sort(explorer::listing& listing) const {
+    const auto& entries = listing.entries;
+    // Reused to avoid allocating for every directory
+    auto reused_keys = reused<std::vector<sort_key>>{};
+    auto& keys = *reused_keys;
+    keys.clear();
+    with_filters(filters_used(listing), [&]<typename Filters>(Filters) {
+        collect<Filters>(listing, keys);
     });
-    if (entries.empty()) {
-        stack.pop_back();
+
+    // Files first, then both sorted by name
+    const auto is_file = [&entries](const sort_key& key) {
+        return entries.types[key.index] != fs::file_type::directory;
+    };
+    const auto directories = std::ranges::partition(keys, is_file);
+    const auto files = std::ranges::subrange(keys.begin(), directories.begin());
+    radix_sort(files, 0);
+    radix_sort(directories, 0);
+
+    listing.order.reserve(keys.size());
+    std::ranges::transform(
+            keys, std::back_inserter(listing.order), &sort_key::index
+    );
+}
+
+void explorer_impl::recurse() {
+    if (!top || front(*top).type != fs::file_type::directory) {
         return;
     }
 
-    static constexpr auto files_first = [](const auto& lhs, const auto& rhs) {
-        return lhs.is_directory() != rhs.is_directory() ? !lhs.is_directory()
-                                                        : lhs < rhs;
-    };
-    std::ranges::sort(entries, files_first);
+    auto& level = own();
+    const auto dir = level.contents->path / front(level).name;
+    // Copied, as descending may release this level
+    const auto parent = level.contents->directory;
+    level.position++;
+    look_ahead();
+    populate(dir, parent);
+
+    unwind();
     recurse();
 }
 
-void explorer_impl::recurse() {
-    if (stack.empty() || !front().is_directory()) {
+void explorer_impl::look_ahead() {
+    if (prefetch == nullptr || options.lookahead == 0) {
         return;
     }
 
-    const auto dir = front().path();
-    stack.back().entries.pop_front();
-    populate(dir);
+    // Directories are sorted after files, and all of those on the top level
+    // are visited before the remaining ones on the level below and so on.
+    // Only the nearest are considered, even if some are already scheduled.
+    auto remaining = options.lookahead;
+    for (auto level = top; level && remaining > 0; level = level->parent) {
+        if (level->pruned) {
+            continue;
+        }
+        const auto& contents = *level->contents;
+        const auto is_file = [&contents](auto index) {
+            return contents.entries.types[index] != fs::file_type::directory;
+        };
+        const auto order = std::span{ contents.order }.subspan(level->position);
+        const auto first = std::ranges::partition_point(order, is_file);
+        const auto count = std::min<std::size_t>(
+                remaining, std::ranges::distance(first, order.end())
+        );
+        for (const auto index : std::ranges::subrange(first, first + count)) {
+            auto path = contents.path / contents.entries[index].name;
+            if (!prefetch->contains(path)) {
+                prefetch->schedule(path, level);
+            }
+        }
+        remaining -= count;
+    }
+}
 
-    while (!stack.empty() && stack.back().entries.empty()) {
-        stack.pop_back();
+void explorer_impl::enter(
+        const fs::path& path, const directory_reader& parent
+) {
+    auto directory = open(path, parent);
+    const auto id = options.follow_symlinks ? directory.id() : file_id{};
+    if (!claim(id)) {
+        return;
+    }
+
+    const bool is_root = directory.contains(dot_git);
+    const bool is_nested = is_root
+            && any_level(top.get(), std::mem_fn(&explorer::listing::is_root));
+    if (is_nested && !options.nested_repositories) {
+        return;
+    }
+
+    const auto gitignore = directory.read(dot_gitignore);
+    auto filter = !gitignore.empty()
+            ? make_filter(gitignore, path / dot_gitignore)
+            : filter::ignore{};
+    auto cone = narrow_cone(path, directory, is_root);
+    auto listing = std::make_shared<explorer::listing>(explorer::listing{
+        .filter = inherit(std::move(filter), is_root),
+        .cone = std::move(cone),
+        .is_root = is_root,
+        .is_nested = is_nested,
+        .path = path,
+        .prefix = make_prefix(path),
+        .directory = std::move(directory),
+        .id = id,
+    });
+    shard(*listing);
+    push(std::move(listing));
+}
+
+void explorer_impl::stream() {
+    while (top) {
+        const auto& listing = *top->contents;
+        // Handle is shared, so copies of explorer share the position
+        auto directory = listing.directory;
+        const auto raw = directory.is_open() ? directory.next() : std::nullopt;
+        if (!raw) {
+            top = top->parent;
+            continue;
+        }
+
+        auto& streamed = own().streamed;
+        streamed.append(raw->name, raw->type);
+        resolve(directory, streamed);
+        const auto item = streamed[0];
+        if (item.type == fs::file_type::directory && top->pruned) {
+            streamed.clear();
+            continue;
+        }
+        const auto filtered = with_filters(
+                filters_used(listing),
+                [&]<typename Filters>(Filters) {
+                    auto path = reused<std::string>{};
+                    return filter_entry<Filters>(listing, item, *path);
+                }
+        );
+        if (filtered) {
+            streamed.clear();
+            continue;
+        }
+        if (item.type != fs::file_type::directory) {
+            return;
+        }
+
+        const auto path = listing.path / item.name;
+        streamed.clear();
+        enter(path, directory);
+    }
+}
+
+void explorer_impl::start(const explorer::root& root) {
+    top = root.outer;
+    if (options.unordered) {
+        enter(root.path, {});
+        stream();
+        return;
+    }
+
+    if (prefetch != nullptr && options.lookahead > 0) {
+        prefetch->schedule(root.path, top);
+    }
+    populate(root.path, {});
+}
+
+void explorer_impl::start_next(
+        const std::vector<explorer::root>& roots, std::size_t& next
+) {
+    while (!top && next < roots.size()) {
+        start(roots[next++]);
     }
-    recurse();
 }
 
 void explorer_impl::next() {
-    stack.back().entries.pop_front();
-    while (!stack.empty() && stack.back().entries.empty()) {
-        stack.pop_back();
+    if (options.unordered) {
+        own().streamed.clear();
+        stream();
+        return;
+    }
+
+    own().position++;
+    unwind();
+    recurse();
+}
+
+// In unbounded mode, directories are scheduled by workers as their parents
+// are read, so those of levels not read by workers are scheduled here
+void explorer_impl::prefetch_remaining(std::span<const explorer::root> roots) {
+    if (prefetch == nullptr || options.lookahead > 0) {
+        return;
+    }
+
+    for (const auto& root : roots) {
+        prefetch->schedule(root.path, root.outer);
+    }
+    for (auto level = top; level; level = level->parent) {
+        if (level->pruned) {
+            continue;
+        }
+        const auto& contents = *level->contents;
+        const auto order = std::span{ contents.order }.subspan(level->position);
+        for (const auto index : order) {
+            const auto item = contents.entries[index];
+            if (item.type == fs::file_type::directory) {
+                prefetch->schedule(contents.path / item.name, level);
+            }
+        }
+    }
+}
+
+void explorer_impl::resume(
+        const explorer::root& root, std::span<const saved_level> levels
+) {
+    top = root.outer;
+    auto parent = directory_reader{};
+    for (const auto& saved : levels) {
+        auto listing = load(saved.path, parent);
+        // Directory was emptied or became ignored since the checkpoint
+        if (!listing) {
+            break;
+        }
+        parent = listing->directory;
+        push(std::move(listing));
+        top->pruned = saved.pruned;
+
+        // Same order as `filter_and_sort`, in case entries changed since
+        const auto& contents = *top->contents;
+        const auto is_before = [&](auto index) {
+            const auto item = contents.entries[index];
+            const bool is_directory = item.type == fs::file_type::directory;
+            return is_directory != saved.is_directory
+                    ? !is_directory
+                    : item.name < saved.name.native();
+        };
+        const auto found
+                = std::ranges::partition_point(contents.order, is_before);
+        top->position = saved.name.empty()
+                ? contents.order.size()
+                : static_cast<std::size_t>(found - contents.order.begin());
     }
+
+    // Entries changed since may have left the level exhausted
+    unwind();
+}
+
+entry explorer_impl::make_entry(
+        const explorer::listing& listing,
+        const explorer::item& item,
+        const explorer_options& options
+) {
+    auto result = entry{};
+    assign(result, listing, item, options);
+    return result;
+}
+
+void explorer_impl::assign(
+        entry& target,
+        const explorer::listing& listing,
+        const explorer::item& item,
+        const explorer_options& options
+) {
+    // Assigned in place to reuse storage of the previous path
+    target.path_value = listing.path;
+    target.path_value /= item.name;
+    target.type_value = item.type;
+    target.has_status = options.metadata;
+    target.size_value = item.size;
+    target.time_value = item.last_write_time;
+}
+
+// Visits entries up to the next directory, which is then descended into
+template <typename Visit>
+std::size_t explorer_impl::drain(std::size_t limit, const Visit& visit) {
+    if (options.unordered) {
+        visit(*top->contents, front(*top));
+        next();
+        return 1;
+    }
+
+    auto& level = own();
+    const auto& contents = *level.contents;
+    auto count = std::size_t{};
+    do {
+        visit(contents, contents.entries[contents.order[level.position]]);
+        count++;
+        level.position++;
+    } while (count < limit && !exhausted(level)
+             && front(level).type != fs::file_type::directory);
+
+    unwind();
     recurse();
+    return count;
+}
+
+// Same walk as `populate` and `recurse`, but suspending on each `load`
+async_generator<entry> explorer_impl::walk(
+        fs::path root, explorer_options options, executor submit
+) {
+    auto top = std::shared_ptr<explorer::level>{};
+    auto counts = explorer::counters{};
+    auto visited = std::make_shared<std::unordered_set<file_id>>();
+    auto impl = explorer_impl{
+        .top = top,
+        .options = options,
+        .counts = counts,
+        .visited = &visited,
+    };
+    const auto descend = [&impl](const auto& path, const auto& parent) {
+        if (auto listing = impl.load(path, parent)) {
+            impl.push(std::move(listing));
+        }
+    };
+    co_await offload{ submit, [&] {
+                         auto known = explorer_impl::outer_levels{};
+                         impl.add_outer_filters(root, known);
+                         descend(root, directory_reader{});
+                     } };
+
+    while (top) {
+        if (exhausted(*top)) {
+            top = top->parent;
+            continue;
+        }
+
+        auto& level = impl.own();
+        const auto item = front(level);
+        if (item.type != fs::file_type::directory) {
+            co_yield make_entry(*level.contents, item, options);
+            level.position++;
+            continue;
+        }
+
+        const auto path = level.contents->path / item.name;
+        const auto parent = level.contents->directory;
+        level.position++;
+        co_await offload{ submit, [&] { descend(path, parent); } };
+    }
+}
+
+async_generator<entry> explore_async(
+        std::filesystem::path root, explorer_options options, executor executor
+) {
+    return explorer_impl::walk(
+            std::move(root),
+            with_implied(std::move(options)),
+            std::move(executor)
+    );
 }
 
 explorer::explorer(
         const std::filesystem::path& root, const explorer_options& options
 ) :
-    options{ options } {
-    auto impl = explorer_impl{ .stack = stack, .options = options };
-    impl.add_outer_filters(root);
-    impl.populate(root);
+    explorer{ std::vector{ root }, options } {}
+
+explorer::explorer(
+        const std::vector<std::filesystem::path>& roots,
+        const explorer_options& options
+) {
+    explorer_impl::prepare(*this, options);
+    explorer_impl::set_roots(*this, roots);
+    auto impl = explorer_impl::of(*this);
+    impl.prefetch_remaining(*this->roots);
+    impl.start_next(*this->roots, next_root);
 }
 
 explorer::reference explorer::operator*() const {
-    return explorer_impl::front(stack);
+    if (!current) {
+        current = explorer_impl::make_entry(
+                *top->contents, explorer_impl::front(*top), *options
+        );
+    }
+    return *current;
 }
 
 explorer::pointer explorer::operator->() const { return &**this; }
 
 explorer& explorer::operator++() {
-    explorer_impl{ .stack = stack, .options = options }.next();
+    current.reset();
+    auto impl = explorer_impl::of(*this);
+    impl.next();
+    impl.start_next(*roots, next_root);
     return *this;
 }
 
+void explorer::disable_recursion_pending() {
+    auto impl = explorer_impl::of(*this);
+    impl.own().pruned = true;
+    // Workers may already be reading them, or even their subdirectories
+    if (prefetch) {
+        prefetch->discard(*top->contents);
+    }
+}
+
+std::size_t explorer::next_batch(std::span<entry> batch) {
+    current.reset();
+    auto impl = explorer_impl::of(*this);
+    auto count = std::size_t{};
+    const auto fill = [&](const listing& contents, const item& item) {
+        explorer_impl::assign(batch[count++], contents, item, *options);
+    };
+    while (top && count < batch.size()) {
+        impl.drain(batch.size() - count, fill);
+        impl.start_next(*roots, next_root);
+    }
+    return count;
+}
+
+std::size_t explorer::visit_batch(
+        std::size_t limit, const std::function<void(const entry_view&)>& visit
+) {
+    current.reset();
+    auto impl = explorer_impl::of(*this);
+    const auto view = [&visit](const listing& contents, const item& item) {
+        visit({
+                .directory = contents.path,
+                .name = item.name,
+                .type = item.type,
+                .size = item.size,
+                .last_write_time = item.last_write_time,
+        });
+    };
+    auto count = std::size_t{};
+    while (top && count < limit) {
+        count += impl.drain(limit - count, view);
+        impl.start_next(*roots, next_root);
+    }
+    return count;
+}
+
+std::string explorer::checkpoint() const {
+    if (options && options->unordered) {
+        throw std::logic_error{ "Unordered explorer cannot be checkpointed" };
+    }
+
+    // Outer levels only hold rules, and are found again from the root
+    auto levels = std::vector<const level*>{};
+    for (const auto* level = top.get(); level != nullptr;
+         level = level->parent.get()) {
+        if (!level->contents->path.empty()) {
+            levels.push_back(level);
+        }
+    }
+
+    auto blob = std::string{ checkpoint_version };
+    const auto first_root = top ? next_root - 1 : next_root;
+    const auto remaining = roots
+            ? std::span{ *roots }.subspan(first_root)
+            : std::span<const root>{};
+    put_number(blob, remaining.size());
+    for (const auto& root : remaining) {
+        put_path(blob, root.path);
+    }
+    // Levels below the first, which is the first remaining root, are stored
+    // by their name, keeping the blob linear in depth
+    put_number(blob, levels.size());
+    for (const auto* level : std::ranges::reverse_view(levels)) {
+        const auto& contents = *level->contents;
+        const bool is_first = level == levels.back();
+        put_path(blob, is_first ? fs::path{} : contents.path.filename());
+        const auto pruned = level->pruned ? level_pruned : char{};
+        if (explorer_impl::exhausted(*level)) {
+            blob += pruned;
+            put_path(blob, {});
+            continue;
+        }
+        const auto item = explorer_impl::front(*level);
+        const bool is_directory
+                = item.type == std::filesystem::file_type::directory;
+        blob += static_cast<char>(
+                pruned | (is_directory ? front_is_directory : char{})
+        );
+        put_path(blob, item.name);
+    }
+    // Directories walked when following symlinks, so links to them are
+    // still rejected after restore
+    put_number(blob, visited ? visited->size() : 0);
+    if (visited) {
+        for (const auto& id : *visited) {
+            put_number(blob, id.device);
+            put_number(blob, id.inode);
+        }
+    }
+    return blob;
+}
+
+explorer explorer::restore(
+        std::string_view checkpoint, const explorer_options& options
+) {
+    if (options.unordered) {
+        throw std::logic_error{ "Unordered explorer cannot be restored" };
+    }
+
+    auto reader = checkpoint_reader{ checkpoint };
+    if (reader.byte() != checkpoint_version) {
+        throw std::invalid_argument{ "Unknown explorer checkpoint version" };
+    }
+    auto paths = std::vector<std::filesystem::path>(reader.size());
+    for (auto& path : paths) {
+        path = reader.path();
+    }
+    auto levels = std::vector<explorer_impl::saved_level>(reader.size());
+    for (auto i = std::size_t{}; i < levels.size(); i++) {
+        auto& level = levels[i];
+        const auto name = reader.path();
+        const bool is_first = i == 0;
+        if (paths.empty() || is_first != name.empty()
+            || name != name.filename()) {
+            throw std::invalid_argument{ "Malformed explorer checkpoint" };
+        }
+        level.path = is_first ? paths.front() : levels[i - 1].path / name;
+        const auto flags = reader.byte();
+        level.is_directory = (flags & front_is_directory) != 0;
+        level.pruned = (flags & level_pruned) != 0;
+        level.name = reader.path();
+    }
+    auto visited = std::vector<file_id>(reader.size());
+    for (auto& id : visited) {
+        id.device = reader.number();
+        id.inode = reader.number();
+    }
+    if (!reader.blob.empty()) {
+        throw std::invalid_argument{ "Malformed explorer checkpoint" };
+    }
+
+    auto result = explorer{};
+    explorer_impl::prepare(result, options);
+    explorer_impl::set_roots(result, paths);
+    auto impl = explorer_impl::of(result);
+    if (!levels.empty() && !result.roots->empty()) {
+        impl.resume(result.roots->front(), levels);
+        result.next_root = 1;
+    }
+    // Added after resuming, as levels resumed are among them
+    if (result.visited) {
+        result.visited->insert(visited.begin(), visited.end());
+    }
+    const auto& roots = *result.roots;
+    impl.prefetch_remaining(std::span{ roots }.subspan(result.next_root));
+    // Front entry may now be a directory
+    impl.look_ahead();
+    impl.recurse();
+    impl.start_next(roots, result.next_root);
+    return result;
+}
+
 explorer explorer::operator++(int) {
     auto copy = *this;
     ++(*this);
     return copy;
 }  // GCOVR_EXCL_LINE: Unknown branch, probably missing nothrow RVO
 
+explorer_stats explorer::stats() const noexcept {
+    if (!counts) {
+        return {};
+    }
+
+    // Workers may still be counting, never report more stats than entries
+    const auto stats = counts->stats.load(std::memory_order_relaxed);
+    const auto entries
+            = std::max(counts->entries.load(std::memory_order_relaxed), stats);
+    return {
+        .entries = entries,
+        .stats_avoided = entries - stats,
+        .stats = stats,
+    };
+}
+
 bool explorer::operator==(const explorer& other) const noexcept {
     // Omit options, as filters are not comparable
-    return stack == other.stack;
+    const auto* lhs = top.get();
+    const auto* rhs = other.top.get();
+    for (; lhs != nullptr && rhs != nullptr;
+         lhs = lhs->parent.get(), rhs = rhs->parent.get()) {
+        // Parents of shared level are shared as well
+        if (lhs == rhs) {
+            return true;
+        }
+        if (!(*lhs == *rhs)) {
+            return false;
+        }
+    }
+    return lhs == rhs;
 }
 
 bool explorer::level::operator==(const level& other) const noexcept {
-    // Don't compare filters as they are transient cache.
-    // Identical entries must have encountered the same filters,
-    // which could be found again from a set of entry parents.
-    // `is_root` is also ignored as more of a filter property.
-    return entries == other.entries;
+    if (streamed != other.streamed || pruned != other.pruned) {
+        return false;
+    }
+    // Listings are never modified, so the same listing at the same position
+    // has the same remaining entries. Copies may still load the same
+    // directory separately, in which case entries have to be compared.
+    if (contents == other.contents) {
+        return position == other.position;
+    }
+    const auto remaining = [](const level& level) {
+        const auto& contents = *level.contents;
+        return std::span{ contents.order }.subspan(level.position)
+                | std::views::transform([&contents](auto index) {
+                       return contents.entries[index];
+                   });
+    };
+    return std::ranges::equal(remaining(*this), remaining(other));
 }
 
 }  // namespace glug::filesystem
-
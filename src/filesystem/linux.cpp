@@ -0,0 +1,562 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#if defined(__linux__)
+
+#include "glug/filesystem/directory.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>) && defined(STATX_BASIC_STATS)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#define GLUG_IO_URING 1
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace glug::filesystem {
+
+namespace {
+
+// Same as glibc uses for `readdir`, big enough for most directories at once
+constexpr auto buffer_size = std::size_t{ 32 } * 1024;
+// Enough for typical depth of tree, as each level holds its buffer
+constexpr auto max_spare_buffers = std::size_t{ 64 };
+
+struct alignas(std::uint64_t) buffer {
+    std::array<std::byte, buffer_size> data;
+};
+
+// Layout defined by kernel ABI, not exposed by any header
+struct linux_dirent64 {
+    std::uint64_t d_ino;
+    std::int64_t d_off;
+    std::uint16_t d_reclen;
+    std::uint8_t d_type;
+    char d_name[1];  // NOLINT(*-avoid-c-arrays): Flexible array member
+};
+
+// Buffers are recycled per thread instead of freed, as every directory
+// needs one and typical walks open thousands of directories
+thread_local auto spare_buffers = std::vector<std::unique_ptr<buffer>>{};
+
+std::unique_ptr<buffer> acquire_buffer() {
+    if (spare_buffers.empty()) {
+        return std::make_unique_for_overwrite<buffer>();
+    }
+    auto result = std::move(spare_buffers.back());
+    spare_buffers.pop_back();
+    return result;
+}
+
+void release_buffer(std::unique_ptr<buffer> released) {
+    if (released && spare_buffers.size() < max_spare_buffers) {
+        spare_buffers.emplace_back(std::move(released));
+    }
+}
+
+[[noreturn]] void throw_error(const char* what, const fs::path& path) {
+    throw fs::filesystem_error{
+        what, path, std::error_code{ errno, std::system_category() }
+    };
+}
+
+fs::file_type to_file_type(std::uint8_t d_type) noexcept {
+    // GCOVR_EXCL_START: Special file types not testable on all OS
+    switch (d_type) {
+        case DT_REG:
+            return fs::file_type::regular;
+        case DT_DIR:
+            return fs::file_type::directory;
+        case DT_LNK:
+            return fs::file_type::symlink;
+        case DT_BLK:
+            return fs::file_type::block;
+        case DT_CHR:
+            return fs::file_type::character;
+        case DT_FIFO:
+            return fs::file_type::fifo;
+        case DT_SOCK:
+            return fs::file_type::socket;
+        default:
+            return fs::file_type::unknown;
+    }
+    // GCOVR_EXCL_STOP
+}
+
+fs::file_type mode_to_file_type(unsigned mode) noexcept {
+    // GCOVR_EXCL_START: Special file types not testable on all OS
+    switch (mode & S_IFMT) {
+        case S_IFREG:
+            return fs::file_type::regular;
+        case S_IFDIR:
+            return fs::file_type::directory;
+        case S_IFLNK:
+            return fs::file_type::symlink;
+        case S_IFBLK:
+            return fs::file_type::block;
+        case S_IFCHR:
+            return fs::file_type::character;
+        case S_IFIFO:
+            return fs::file_type::fifo;
+        case S_IFSOCK:
+            return fs::file_type::socket;
+        default:
+            return fs::file_type::unknown;
+    }
+    // GCOVR_EXCL_STOP
+}
+
+fs::file_time_type to_file_time(std::int64_t sec, std::int64_t nsec) {
+    namespace chrono = std::chrono;
+    const auto since_epoch = chrono::sys_time<chrono::nanoseconds>{
+        chrono::seconds{ sec } + chrono::nanoseconds{ nsec }
+    };
+    return chrono::time_point_cast<fs::file_time_type::duration>(
+            chrono::file_clock::from_sys(since_epoch)
+    );
+}
+
+raw_status
+stat_at(int directory, const char* name, bool follow_symlinks) noexcept {
+    const auto flags = follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW;
+    struct stat status {};
+    if (::fstatat(directory, name, &status, flags) != 0) {
+        return { .type = fs::file_type::not_found };
+    }
+    return {
+        .type = mode_to_file_type(status.st_mode),
+        .size = static_cast<std::uintmax_t>(status.st_size),
+        .last_write_time
+        = to_file_time(status.st_mtim.tv_sec, status.st_mtim.tv_nsec),
+    };
+}
+
+#if defined(GLUG_IO_URING)
+
+// Bare io_uring with just enough to batch `statx`, as liburing is not
+// available everywhere. Any failure to set up, e.g. kernel too old or
+// io_uring forbidden by seccomp, leaves it closed for callers to fall back.
+class ring {
+    public:
+    static constexpr auto capacity = 64U;
+
+    // Limit of entries per `io_uring_enter`, if non-zero, to test partial
+    // submits without relying on the kernel to make them
+    explicit ring(unsigned limit = 0) noexcept;
+    ring(const ring&) = delete;
+    ring(ring&&) = delete;
+    ring& operator=(const ring&) = delete;
+    ring& operator=(ring&&) = delete;
+    ~ring() { close(); }
+
+    [[nodiscard]] bool is_open() const noexcept { return fd >= 0; }
+
+    /**
+     * Stats up to `capacity` names, usually with a single `io_uring_enter`.
+     *
+     * @returns false if the batch could not be submitted
+     */
+    bool stat(
+            int directory,
+            std::span<const char* const> names,
+            std::span<raw_status> result,
+            bool follow_symlinks
+    ) noexcept;
+
+    private:
+    struct mapping {
+        void* data{ MAP_FAILED };
+        std::size_t size{};
+    };
+
+    void close() noexcept;
+    template <typename T>
+    T* at(const mapping& map, std::uint32_t offset) const noexcept {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-*): Kernel ABI
+        return reinterpret_cast<T*>(static_cast<std::byte*>(map.data) + offset);
+    }
+
+    unsigned submit_limit{};
+    int fd{ -1 };
+    io_uring_params params{};
+    mapping sq{};
+    mapping cq{};
+    mapping sqes{};
+    std::array<struct statx, capacity> buffers{};
+};
+
+ring::ring(unsigned limit) noexcept :
+    submit_limit{ limit != 0 ? limit : ~0U } {
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, capacity, &params));
+    if (fd < 0) {
+        return;
+    }
+
+    // GCOVR_EXCL_START: Depends on kernel version and configuration
+    const auto map = [this](std::size_t size, std::uint64_t offset) {
+        return mapping{
+            ::mmap(nullptr,
+                   size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE,
+                   fd,
+                   static_cast<off_t>(offset)),
+            size,
+        };
+    };
+    const auto sq_size = params.sq_off.array
+            + (params.sq_entries * sizeof(std::uint32_t));
+    const auto cq_size = params.cq_off.cqes
+            + (params.cq_entries * sizeof(io_uring_cqe));
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        sq = map(std::max(sq_size, cq_size), IORING_OFF_SQ_RING);
+    } else {
+        sq = map(sq_size, IORING_OFF_SQ_RING);
+        cq = map(cq_size, IORING_OFF_CQ_RING);
+    }
+    sqes = map(params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES);
+    const bool mapped = sq.data != MAP_FAILED && sqes.data != MAP_FAILED
+            && ((params.features & IORING_FEAT_SINGLE_MMAP) != 0
+                || cq.data != MAP_FAILED);
+
+    // Probe, as `IORING_OP_STATX` is newer than io_uring itself
+    static constexpr auto probe_size = sizeof(io_uring_probe)
+            + (IORING_OP_LAST * sizeof(io_uring_probe_op));
+    alignas(io_uring_probe) auto probe_buffer
+            = std::array<std::byte, probe_size>{};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-*): Kernel ABI
+    const auto* probe = reinterpret_cast<io_uring_probe*>(probe_buffer.data());
+    const bool probed = ::syscall(
+                                __NR_io_uring_register,
+                                fd,
+                                IORING_REGISTER_PROBE,
+                                probe_buffer.data(),
+                                IORING_OP_LAST
+                        )
+            == 0;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-*): Flexible array member
+    const auto statx_flags = probe->ops[IORING_OP_STATX].flags;
+    const bool supported = probed && probe->last_op >= IORING_OP_STATX
+            && (statx_flags & IO_URING_OP_SUPPORTED) != 0;
+    if (!mapped || !supported) {
+        close();
+    }
+    // GCOVR_EXCL_STOP
+}
+
+void ring::close() noexcept {
+    for (auto* map : { &sq, &cq, &sqes }) {
+        if (map->data != MAP_FAILED) {
+            ::munmap(map->data, map->size);
+            *map = {};
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool ring::stat(
+        int directory,
+        std::span<const char* const> names,
+        std::span<raw_status> result,
+        bool follow_symlinks
+) noexcept {
+    const auto& cq_map = cq.data != MAP_FAILED ? cq : sq;
+    const auto sq_mask = *at<std::uint32_t>(sq, params.sq_off.ring_mask);
+    auto* sq_array = at<std::uint32_t>(sq, params.sq_off.array);
+    auto sq_tail
+            = std::atomic_ref{ *at<std::uint32_t>(sq, params.sq_off.tail) };
+    const auto cq_mask = *at<std::uint32_t>(cq_map, params.cq_off.ring_mask);
+    auto* cqes = at<io_uring_cqe>(cq_map, params.cq_off.cqes);
+    auto cq_head
+            = std::atomic_ref{ *at<std::uint32_t>(cq_map, params.cq_off.head) };
+    auto cq_tail
+            = std::atomic_ref{ *at<std::uint32_t>(cq_map, params.cq_off.tail) };
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-*): Kernel ABI
+    const auto count = static_cast<unsigned>(names.size());
+    auto tail = sq_tail.load(std::memory_order_relaxed);
+    for (auto i = 0U; i < count; i++, tail++) {
+        const auto index = tail & sq_mask;
+        auto& sqe = at<io_uring_sqe>(sqes, 0)[index];
+        sqe = io_uring_sqe{};
+        sqe.opcode = IORING_OP_STATX;
+        sqe.fd = directory;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(names[i]);
+        sqe.len = STATX_TYPE | STATX_SIZE | STATX_MTIME;
+        sqe.off = reinterpret_cast<std::uintptr_t>(&buffers.at(i));
+        sqe.statx_flags = follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW;
+        sqe.user_data = i;
+        sq_array[index] = index;
+    }
+    sq_tail.store(tail, std::memory_order_release);
+
+    // Kernel may accept fewer entries than asked, so keep submitting the rest
+    // and only ever wait for completions of what it has actually taken
+    auto submitted = 0U;
+    auto completed = 0U;
+    while (completed < count) {
+        const auto to_submit = std::min(count - submitted, submit_limit);
+        const auto entered = ::syscall(
+                __NR_io_uring_enter,
+                fd,
+                to_submit,
+                submitted + to_submit - completed,
+                IORING_ENTER_GETEVENTS,
+                nullptr,
+                0
+        );
+        if (entered > 0) {
+            submitted += static_cast<unsigned>(entered);
+        }
+        // GCOVR_EXCL_START: Only fails on resource exhaustion or signals
+        if (entered < 0 && errno != EINTR) {
+            // Closing cancels whatever might still be in flight
+            close();
+            return false;
+        }
+        // GCOVR_EXCL_STOP
+
+        auto head = cq_head.load(std::memory_order_relaxed);
+        for (; head != cq_tail.load(std::memory_order_acquire); head++) {
+            const auto& cqe = cqes[head & cq_mask];
+            const auto& buffer = buffers.at(cqe.user_data);
+            auto& status = result[cqe.user_data];
+            completed++;
+            if (cqe.res < 0) {
+                status = { .type = fs::file_type::not_found };
+                continue;
+            }
+            status = {
+                .type = mode_to_file_type(buffer.stx_mode),
+                .size = buffer.stx_size,
+                .last_write_time = to_file_time(
+                        buffer.stx_mtime.tv_sec, buffer.stx_mtime.tv_nsec
+                ),
+            };
+        }
+        cq_head.store(head, std::memory_order_release);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-*)
+    return true;
+}
+
+// One per thread, as submission queue has a single producer
+thread_local auto uring = std::optional<ring>{};
+
+#endif
+
+}  // namespace
+
+namespace detail {
+
+struct directory {
+    directory(int fd, fs::path path) noexcept :
+        fd{ fd },
+        path{ std::move(path) } {}
+    directory(const directory&) = delete;
+    directory(directory&&) = delete;
+    directory& operator=(const directory&) = delete;
+    directory& operator=(directory&&) = delete;
+    ~directory() {
+        release_buffer(std::move(data));
+        ::close(fd);
+    }
+
+    int fd{ -1 };
+    // Only to name the directory, or its children, in errors
+    fs::path path{};
+    std::unique_ptr<buffer> data{ acquire_buffer() };
+    std::size_t offset{};
+    std::size_t size{};
+};
+
+void limit_submissions(unsigned limit) {
+#if defined(GLUG_IO_URING)
+    uring.reset();
+    uring.emplace(limit);
+#else
+    static_cast<void>(limit);
+#endif
+}
+
+}  // namespace detail
+
+directory_reader::directory_reader(const fs::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw_error("directory_reader", path);
+    }
+    pimpl = std::make_shared<detail::directory>(fd, path);
+}
+
+directory_reader::directory_reader(
+        const directory_reader& parent,
+        const fs::path& name,
+        bool follow_symlinks
+) {
+    if (parent.handle) {
+        handle = parent.handle->open(name, follow_symlinks);
+        return;
+    }
+
+    // Built before opening, so that allocating cannot clobber `errno`
+    auto path = parent.pimpl->path / name;
+    const int fd = ::openat(
+            parent.pimpl->fd,
+            name.c_str(),
+            O_RDONLY | O_DIRECTORY | O_CLOEXEC
+                    | (follow_symlinks ? 0 : O_NOFOLLOW)
+    );
+    if (fd < 0) {
+        throw_error("directory_reader", path);
+    }
+    pimpl = std::make_shared<detail::directory>(fd, std::move(path));
+}
+
+file_id directory_reader::id() const {
+    if (handle) {
+        return handle->id();
+    }
+
+    struct stat status {};
+    if (::fstat(pimpl->fd, &status) != 0) {
+        return {};  // GCOVR_EXCL_LINE: Open descriptor is always valid
+    }
+    return { .device = status.st_dev, .inode = status.st_ino };
+}
+
+std::optional<raw_entry> directory_reader::next() {
+    using namespace std::string_view_literals;
+
+    if (handle) {
+        return handle->next();
+    }
+
+    auto& dir = *pimpl;
+    while (dir.data) {
+        if (dir.offset == dir.size) {
+            const auto read = ::syscall(
+                    SYS_getdents64, dir.fd, dir.data->data.data(), buffer_size
+            );
+            if (read < 0) {
+                throw_error("directory_reader::next", dir.path);
+            }
+            if (read == 0) {
+                // Keep the descriptor open for `openat`, but not the buffer
+                release_buffer(std::move(dir.data));
+                return std::nullopt;
+            }
+            dir.offset = 0;
+            dir.size = static_cast<std::size_t>(read);
+        }
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-*): Kernel ABI
+        const auto* record = reinterpret_cast<const linux_dirent64*>(
+                dir.data->data.data() + dir.offset
+        );
+        dir.offset += record->d_reclen;
+        const auto name = std::string_view{ &record->d_name[0] };
+        // NOLINTEND(cppcoreguidelines-pro-*)
+        if (name == "."sv || name == ".."sv) {
+            continue;
+        }
+        return raw_entry{ name, to_file_type(record->d_type) };
+    }
+    return std::nullopt;
+}
+
+bool directory_reader::contains(const fs::path& name) const {
+    return type(name) != fs::file_type::not_found;
+}
+
+fs::file_type directory_reader::type(const fs::path& name) const {
+    if (handle) {
+        return handle->type(name);
+    }
+
+    return stat_at(pimpl->fd, name.c_str(), false).type;
+}
+
+std::vector<raw_status> directory_reader::status(
+        std::span<const char* const> names, bool follow_symlinks
+) const {
+    if (handle) {
+        return handle->status(names, follow_symlinks);
+    }
+
+    auto result = std::vector<raw_status>(names.size());
+    auto offset = std::size_t{};
+#if defined(GLUG_IO_URING)
+    // Single entries gain nothing from a round trip through the ring
+    if (names.size() > 1 && !uring) {
+        uring.emplace();
+    }
+    while (names.size() - offset > 1 && uring->is_open()) {
+        const auto count = std::min<std::size_t>(
+                names.size() - offset, ring::capacity
+        );
+        if (!uring->stat(
+                    pimpl->fd,
+                    names.subspan(offset, count),
+                    std::span{ result }.subspan(offset, count),
+                    follow_symlinks
+            )) {
+            break;  // GCOVR_EXCL_LINE: Only fails on resource exhaustion
+        }
+        offset += count;
+    }
+#endif
+    for (; offset < names.size(); offset++) {
+        result[offset] = stat_at(pimpl->fd, names[offset], follow_symlinks);
+    }
+    return result;
+}
+
+std::string directory_reader::read(const fs::path& name) const {
+    if (handle) {
+        return handle->read(name);
+    }
+
+    const int fd = ::openat(pimpl->fd, name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return {};
+    }
+
+    auto result = std::string{};
+    auto chunk = std::array<char, 4096>{};
+    auto read = ::read(fd, chunk.data(), chunk.size());
+    while (read > 0) {
+        result.append(chunk.data(), static_cast<std::size_t>(read));
+        read = ::read(fd, chunk.data(), chunk.size());
+    }
+    ::close(fd);
+    return result;
+}
+
+}  // namespace glug::filesystem
+
+#endif
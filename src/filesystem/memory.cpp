@@ -0,0 +1,356 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/filesystem/memory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace glug::filesystem {
+
+namespace {
+
+// Absolute path within the tree, with "." and ".." resolved
+fs::path normalize(const fs::path& path) {
+    return (fs::path{ "/" } / path.relative_path()).lexically_normal();
+}
+
+// Names leading from root of the tree to the path
+std::vector<fs::path> split(const fs::path& path) {
+    auto result = std::vector<fs::path>{};
+    for (const auto& part : normalize(path).relative_path()) {
+        // Trailing separator is an empty name
+        if (!part.empty()) {
+            result.push_back(part);
+        }
+    }
+    return result;
+}
+
+fs::filesystem_error make_error(const fs::path& path, std::errc error) {
+    return fs::filesystem_error{
+        "glug::filesystem::memory_tree",
+        path,
+        std::make_error_code(error),
+    };
+}
+
+std::string read_file(const fs::path& path) {
+    auto stream = std::ifstream{ path, std::ios::binary };
+    return std::string{ std::istreambuf_iterator<char>{ stream }, {} };
+}
+
+// Path in first line of file, after prefix if any, relative to its directory
+std::optional<fs::path>
+read_link(const fs::path& path, std::string_view prefix = {}) {
+    const auto contents = read_file(path);
+    auto line = std::string_view{ contents };
+    line = line.substr(0, line.find_first_of("\r\n"));
+    if (!line.starts_with(prefix)) {
+        return std::nullopt;
+    }
+    line.remove_prefix(prefix.size());
+    while (line.starts_with(' ')) {
+        line.remove_prefix(1);
+    }
+    if (line.empty()) {
+        return std::nullopt;
+    }
+    return (path.parent_path() / fs::path{ line }).lexically_normal();
+}
+
+}  // namespace
+
+struct memory_tree::node {
+    fs::file_type type{};
+    std::string contents{};
+    // Sorted, so that walks are reproducible unlike on most filesystems
+    std::map<fs::path::string_type, std::unique_ptr<node>> children{};
+
+    [[nodiscard]] const node* find(const fs::path& name) const {
+        const auto it = children.find(name.native());
+        return it != children.end() ? it->second.get() : nullptr;
+    }
+};
+
+class memory_tree::handle : public directory_handle {
+    public:
+    // Aliases the root, keeping the whole tree alive
+    explicit handle(std::shared_ptr<const node> directory) :
+        directory{ std::move(directory) },
+        position{ this->directory->children.begin() } {}
+
+    [[nodiscard]] std::shared_ptr<directory_handle>
+    open(const fs::path& name, bool follow_symlinks) const override {
+        const auto* child = directory->find(name);
+        if (child == nullptr) {
+            throw make_error(name, std::errc::no_such_file_or_directory);
+        }
+        if (child->type == fs::file_type::symlink && follow_symlinks) {
+            throw make_error(name, std::errc::operation_not_supported);
+        }
+        if (child->type != fs::file_type::directory) {
+            throw make_error(name, std::errc::not_a_directory);
+        }
+        return std::make_shared<handle>(
+                std::shared_ptr<const node>{ directory, child }
+        );
+    }
+
+    [[nodiscard]] file_id id() const override {
+        // Nodes never move, so address is as unique as an inode
+        return { .inode = reinterpret_cast<std::uintptr_t>(directory.get()) };
+    }
+
+    [[nodiscard]] std::optional<raw_entry> next() override {
+        if (position == directory->children.end()) {
+            return std::nullopt;
+        }
+        const auto& [name, child] = *position++;
+        return raw_entry{ .name = name, .type = child->type };
+    }
+
+    [[nodiscard]] fs::file_type type(const fs::path& name) const override {
+        const auto* child = directory->find(name);
+        return child != nullptr ? child->type : fs::file_type::not_found;
+    }
+
+    [[nodiscard]] std::vector<raw_status> status(
+            std::span<const fs::path::value_type* const> names,
+            bool follow_symlinks
+    ) const override {
+        auto result = std::vector<raw_status>{};
+        result.reserve(names.size());
+        for (const auto* name : names) {
+            const auto* child = directory->find(name);
+            if (child == nullptr
+                || (child->type == fs::file_type::symlink && follow_symlinks)) {
+                result.push_back({ .type = fs::file_type::not_found });
+                continue;
+            }
+            result.push_back({
+                    .type = child->type,
+                    .size = child->contents.size(),
+            });
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::string read(const fs::path& name) const override {
+        const auto* child = directory->find(name);
+        if (child == nullptr || child->type != fs::file_type::regular) {
+            return {};
+        }
+        return child->contents;
+    }
+
+    private:
+    std::shared_ptr<const node> directory{};
+    decltype(node::children)::const_iterator position{};
+};
+
+memory_tree::memory_tree() :
+    root{ std::make_shared<node>(node{ .type = fs::file_type::directory }) } {}
+
+memory_tree memory_tree::parse(std::string_view listing) {
+    auto result = memory_tree{};
+    node* file = nullptr;
+    while (!listing.empty()) {
+        const auto end = listing.find('\n');
+        auto line = listing.substr(0, end);
+        listing.remove_prefix(
+                end != std::string_view::npos ? end + 1 : listing.size()
+        );
+
+        if (line.starts_with('\t')) {
+            if (file != nullptr) {
+                file->contents.append(line.substr(1)).push_back('\n');
+            }
+            continue;
+        }
+
+        file = nullptr;
+        if (line.ends_with('/')) {
+            result.add_directory(line);
+        } else if (line.ends_with('@')) {
+            line.remove_suffix(1);
+            result.add_symlink(line);
+        } else if (!line.empty()) {
+            file = &result.add(line, fs::file_type::regular);
+        }
+    }
+    return result;
+}
+
+memory_tree memory_tree::record(const fs::path& root) {
+    auto result = memory_tree{};
+    // Git directories of worktrees and submodules, recorded once the rest
+    // is, as they may also be walked as ordinary directories
+    auto linked = std::vector<fs::path>{};
+    for (auto it = fs::recursive_directory_iterator{ root };
+         it != fs::recursive_directory_iterator{};
+         ++it) {
+        const auto& entry = *it;
+        const auto path = entry.path().lexically_relative(root);
+        if (entry.is_symlink()) {
+            result.add_symlink(path);
+        } else if (entry.is_directory()) {
+            result.add_directory(path);
+            if (path.filename() == ".git") {
+                it.disable_recursion_pending();
+                result.record_git(entry.path(), path);
+            }
+        } else if (entry.is_regular_file()) {
+            const auto is_gitignore = path.filename() == ".gitignore";
+            const auto is_git = path.filename() == ".git";
+            result.add_file(
+                    path,
+                    is_gitignore || is_git ? read_file(entry.path())
+                                           : std::string{}
+            );
+            const auto git = is_git ? read_link(entry.path(), "gitdir:")
+                                    : std::nullopt;
+            if (git) {
+                linked.push_back(*git);
+            }
+        }
+    }
+
+    // Only those within the tree, which the copy can point to
+    const auto record_inside = [&root, &result](const fs::path& git) {
+        const auto path = git.lexically_relative(root);
+        if (!path.empty() && *path.begin() != ".."
+            && fs::is_directory(git)) {
+            result.record_git(git, path);
+        }
+    };
+    for (const auto& git : linked) {
+        record_inside(git);
+        // Worktrees share config with the main repository
+        if (const auto common = read_link(git / "commondir")) {
+            record_inside(*common);
+        }
+    }
+    return result;
+}
+
+void memory_tree::record_git(
+        const fs::path& source, const fs::path& destination
+) {
+    // Only files read by explorer, to decide what is checked out
+    const auto names = {
+        "config", "config.worktree", "commondir", "info/sparse-checkout",
+    };
+    for (const auto* name : names) {
+        if (fs::is_regular_file(source / name)) {
+            add_file(destination / name, read_file(source / name));
+        }
+    }
+}
+
+std::string memory_tree::listing() const {
+    auto result = std::string{};
+    const auto append = [&result](
+                                const auto& self,
+                                const node& directory,
+                                const std::string& prefix
+                        ) -> void {
+        for (const auto& [name, child] : directory.children) {
+            const auto path = prefix + fs::path{ name }.generic_string();
+            if (child->type == fs::file_type::directory) {
+                result.append(path).append("/\n");
+                self(self, *child, path + "/");
+            } else if (child->type == fs::file_type::symlink) {
+                result.append(path).append("@\n");
+            } else {
+                result.append(path).push_back('\n');
+                auto contents = std::string_view{ child->contents };
+                while (!contents.empty()) {
+                    const auto end = contents.find('\n');
+                    result.append("\t").append(contents.substr(0, end));
+                    result.push_back('\n');
+                    contents.remove_prefix(
+                            end != std::string_view::npos ? end + 1
+                                                          : contents.size()
+                    );
+                }
+            }
+        }
+    };
+    append(append, *root, "");
+    return result;
+}
+
+void memory_tree::add_file(const fs::path& path, std::string contents) {
+    add(path, fs::file_type::regular).contents = std::move(contents);
+}
+
+void memory_tree::add_directory(const fs::path& path) {
+    add(path, fs::file_type::directory);
+}
+
+void memory_tree::add_symlink(const fs::path& path) {
+    add(path, fs::file_type::symlink);
+}
+
+memory_tree::node&
+memory_tree::add(const fs::path& path, fs::file_type type) {
+    const auto names = split(path);
+    auto* current = root.get();
+    for (auto i = std::size_t{ 0 }; i < names.size(); i++) {
+        const auto wanted
+                = i + 1 < names.size() ? fs::file_type::directory : type;
+        auto& child = current->children[names[i].native()];
+        // Keep existing directories, replace anything else
+        if (!child || child->type != wanted
+            || wanted != fs::file_type::directory) {
+            child = std::make_unique<node>(node{ .type = wanted });
+        }
+        current = child.get();
+    }
+    return *current;
+}
+
+directory_reader memory_tree::open(const fs::path& path) const {
+    const node* current = root.get();
+    for (const auto& name : split(path)) {
+        current = current->find(name);
+        if (current == nullptr) {
+            throw make_error(path, std::errc::no_such_file_or_directory);
+        }
+        if (current->type != fs::file_type::directory) {
+            throw make_error(path, std::errc::not_a_directory);
+        }
+    }
+    return directory_reader{
+        std::make_shared<handle>(std::shared_ptr<const node>{ root, current }),
+    };
+}
+
+fs::path memory_tree::canonical(const fs::path& path) const {
+    auto result = fs::path{ "/" };
+    const node* current = root.get();
+    for (const auto& name : split(path)) {
+        current = current->find(name);
+        if (current == nullptr) {
+            throw make_error(path, std::errc::no_such_file_or_directory);
+        }
+        result /= name;
+    }
+    return result;
+}
+
+}  // namespace glug::filesystem
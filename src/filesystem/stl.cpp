@@ -0,0 +1,165 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#if !defined(__linux__)
+
+#include "glug/filesystem/directory.hpp"
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace glug::filesystem {
+
+namespace detail {
+
+struct directory {
+    explicit directory(fs::path path) :
+        path{ std::move(path) },
+        iterator{ this->path } {}
+
+    fs::path path{};
+    fs::directory_iterator iterator{};
+    fs::path::string_type name{};
+};
+
+// No io_uring, so no submissions to limit
+void limit_submissions(unsigned /*limit*/) {}
+
+}  // namespace detail
+
+directory_reader::directory_reader(const fs::path& path) :
+    pimpl{ std::make_shared<detail::directory>(path) } {}
+
+// Without descriptors, symlinks cannot be opened without following
+directory_reader::directory_reader(
+        const directory_reader& parent,
+        const fs::path& name,
+        bool follow_symlinks
+) {
+    if (parent.handle) {
+        handle = parent.handle->open(name, follow_symlinks);
+        return;
+    }
+
+    pimpl = std::make_shared<detail::directory>(parent.pimpl->path / name);
+}
+
+file_id directory_reader::id() const {
+    if (handle) {
+        return handle->id();
+    }
+
+#if defined(_WIN32)
+    // No inodes, but canonical path is just as unique for directories
+    auto error = std::error_code{};
+    const auto canonical = fs::canonical(pimpl->path, error);
+    return { .inode = std::hash<fs::path::string_type>{}(canonical.native()) };
+#else
+    struct stat status {};
+    if (::stat(pimpl->path.c_str(), &status) != 0) {
+        return {};
+    }
+    return {
+        .device = static_cast<std::uint64_t>(status.st_dev),
+        .inode = static_cast<std::uint64_t>(status.st_ino),
+    };
+#endif
+}
+
+std::optional<raw_entry> directory_reader::next() {
+    if (handle) {
+        return handle->next();
+    }
+
+    auto& dir = *pimpl;
+    if (dir.iterator == fs::directory_iterator{}) {
+        return std::nullopt;
+    }
+
+    // Same queries as on `directory_entry` before, using its cached type
+    const auto& entry = *dir.iterator;
+    // GCOVR_EXCL_START: Special file types not testable on all OS
+    const auto type = entry.is_symlink() ? fs::file_type::symlink
+            : entry.is_directory()       ? fs::file_type::directory
+            : entry.is_regular_file()    ? fs::file_type::regular
+                                         : entry.status().type();
+    // GCOVR_EXCL_STOP
+    dir.name = entry.path().filename().native();
+    ++dir.iterator;
+    return raw_entry{ dir.name, type };
+}
+
+bool directory_reader::contains(const fs::path& name) const {
+    return type(name) != fs::file_type::not_found;
+}
+
+fs::file_type directory_reader::type(const fs::path& name) const {
+    if (handle) {
+        return handle->type(name);
+    }
+
+    // Unlike for missing files, other errors such as EACCES report `none`
+    auto error = std::error_code{};
+    const auto type = fs::symlink_status(pimpl->path / name, error).type();
+    return error ? fs::file_type::not_found : type;
+}
+
+std::vector<raw_status> directory_reader::status(
+        std::span<const fs::path::value_type* const> names, bool follow_symlinks
+) const {
+    if (handle) {
+        return handle->status(names, follow_symlinks);
+    }
+
+    auto result = std::vector<raw_status>{};
+    result.reserve(names.size());
+    for (const auto* name : names) {
+        const auto path = pimpl->path / name;
+        auto error = std::error_code{};
+        const auto type = follow_symlinks
+                ? fs::status(path, error).type()
+                : fs::symlink_status(path, error).type();
+        auto& status = result.emplace_back(raw_status{
+                .type = error ? fs::file_type::not_found : type,
+        });
+        if (status.type == fs::file_type::regular) {
+            status.size = fs::file_size(path, error);
+            status.last_write_time = fs::last_write_time(path, error);
+        }
+    }
+    return result;
+}
+
+std::string directory_reader::read(const fs::path& name) const {
+    if (handle) {
+        return handle->read(name);
+    }
+
+    // Unlike `istreambuf_iterator`, `read` does not throw for directories
+    auto stream = std::ifstream{ pimpl->path / name, std::ios::binary };
+    auto result = std::string{};
+    auto chunk = std::array<char, 4096>{};
+    while (stream.read(chunk.data(), chunk.size()) || stream.gcount() > 0) {
+        result.append(chunk.data(), static_cast<std::size_t>(stream.gcount()));
+    }
+    return result;
+}
+
+}  // namespace glug::filesystem
+
+#endif
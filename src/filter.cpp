@@ -5,12 +5,15 @@
 #include "glug/glob.hpp"
 
 #include <algorithm>
+#include <cstddef>
 #include <filesystem>
 #include <functional>
 #include <iterator>
+#include <optional>
 #include <ostream>
 #include <ranges>
 #include <span>
+#include <string>
 #include <string_view>
 #include <type_traits>
 #include <vector>
@@ -42,6 +45,38 @@ decltype(auto) fix_path_separator(const std::filesystem::path& path) noexcept {
     }
 }
 
+// Prefix of paths below anchor, which the root directory already ends with
+std::string make_prefix(const std::filesystem::path& anchor) {
+    auto result = fix_path_separator(anchor).string();
+    if (!result.ends_with('/')) {
+        result.push_back('/');
+    }
+    return result;
+}
+
+auto split_path(std::string_view path) {
+    return path | std::views::split('/')
+            | std::views::filter([](const auto& part) { return !part.empty(); })
+            | std::views::transform([](const auto& part) {
+                   return std::string_view{ part.begin(), part.end() };
+               });
+}
+
+// Directory relative to anchor, empty for anchor itself
+std::optional<std::string_view> relative_to(
+        std::string_view directory, std::string_view anchor_prefix
+) noexcept {
+    if (anchor_prefix.size() == directory.size() + 1
+        && anchor_prefix.starts_with(directory)) {
+        return std::string_view{};
+    }
+    if (!directory.starts_with(anchor_prefix)) {
+        return std::nullopt;
+    }
+    directory.remove_prefix(anchor_prefix.size());
+    return directory;
+}
+
 }  // namespace
 
 ignore::ignore(
@@ -49,8 +84,7 @@ ignore::ignore(
         const std::filesystem::path& anchor
 ) {
     // PERF: Lazy
-    const auto anchor_prefix
-            = glob::glob_escape(fix_path_separator(anchor).string()) + "/";
+    const auto anchor_prefix = glob::glob_escape(make_prefix(anchor));
 
     auto anchored_pattern = std::string{};
     items.reserve(globs.size());
@@ -92,8 +126,22 @@ ignore::ignore(
         anchor,
     } {}
 
+ignore::ignore(const ignore& parent, const ignore& nested) {
+    // Last matching glob decides, so those of `nested` are checked first
+    items.reserve(parent.items.size() + nested.items.size());
+    items.insert(items.end(), parent.items.begin(), parent.items.end());
+    items.insert(items.end(), nested.items.begin(), nested.items.end());
+}
+
 decision
 ignore::apply(const std::filesystem::directory_entry& entry) const noexcept {
+    return apply(
+            fix_path_separator(entry.path()).string(), entry.is_directory()
+    );
+}
+
+decision
+ignore::apply(std::string_view path, bool is_directory) const noexcept {
     const auto make_decision = [&items = items](const auto& it) {
         if (it == items.rend()) {
             return decision::undecided;
@@ -101,14 +149,11 @@ ignore::apply(const std::filesystem::directory_entry& entry) const noexcept {
         return it->is_inverted ? decision::included : decision::excluded;
     };
 
-    // PERF: Move to caller to deduplicate calculations with multi-level ignore
-    const auto& full = fix_path_separator(entry.path());
-    const auto& file = entry.path().filename();
-    const auto match = [&entry, &full, &file](const auto& item) noexcept {
-        const auto& path = item.is_anchored ? full : file;
-        return item.is_directory && !entry.is_directory()
+    const auto file = path.substr(path.rfind('/') + 1);
+    const auto match = [is_directory, path, file](const auto& item) noexcept {
+        return item.is_directory && !is_directory
                 ? false
-                : item.regex(path.string());
+                : item.regex(item.is_anchored ? path : file);
     };
     return make_decision(
             std::ranges::find_if(std::ranges::reverse_view(items), match)
@@ -119,8 +164,7 @@ select::select(
         std::span<const glob::decomposition> globs,
         const std::filesystem::path& anchor
 ) {
-    const auto anchor_prefix
-            = glob::glob_escape(fix_path_separator(anchor).string()) + "/";
+    const auto anchor_prefix = glob::glob_escape(make_prefix(anchor));
 
     dirs.reserve(
             std::count_if(
@@ -150,6 +194,30 @@ select::select(
             fallback = decision::excluded;
         }
     }
+
+    const auto is_scope = [](const auto& glob) {
+        return !glob.is_inverted && !glob.is_directory;
+    };
+    const bool all_anchored = std::ranges::all_of(globs, [&](const auto& glob) {
+        return !is_scope(glob) || glob.is_anchored;
+    });
+    if (!all_anchored) {
+        return;
+    }
+
+    scope_anchor = make_prefix(anchor);
+    for (const auto& glob : globs | std::views::filter(is_scope)) {
+        auto& scope = scopes.emplace_back();
+        for (const auto part : split_path(glob.pattern)) {
+            auto& segment = scope.emplace_back();
+            segment.is_globstar = part == "**";
+            if (part.find_first_of("*?[\\") == std::string_view::npos) {
+                segment.literal = part;
+            } else if (!segment.is_globstar) {
+                segment.regex = regex::engine{ glob::to_regex(part) };
+            }
+        }
+    }
 }
 
 select::select(
@@ -171,19 +239,229 @@ select::apply(const std::filesystem::directory_entry& entry) const noexcept {
         return decision::undecided;
     }
 
-    const auto& full = fix_path_separator(entry.path());
-    const auto& file = entry.path().filename();
-    const auto match = [&full, &file](const auto& item) noexcept {
-        const auto& path = item.is_anchored ? full : file;
-        return item.regex(path.string());
+    return apply(
+            fix_path_separator(entry.path()).string(), entry.is_directory()
+    );
+}
+
+namespace {
+
+// Index of glob segment matching next subdirectory, `npos` if a globstar
+// was reached and anything may follow, nothing if directory cannot match
+std::optional<std::size_t>
+reach(const auto& scope, std::string_view relative) noexcept {
+    auto index = std::size_t{};
+    for (const auto part : split_path(relative)) {
+        const auto& segment = scope[index];
+        if (segment.is_globstar) {
+            return std::string_view::npos;
+        }
+        // Last segment only matches files
+        if (index + 1 == scope.size()) {
+            return std::nullopt;
+        }
+        const bool matches = segment.literal.empty() ? segment.regex(part)
+                                                     : segment.literal == part;
+        if (!matches) {
+            return std::nullopt;
+        }
+        index++;
+    }
+    return index;
+}
+
+}  // namespace
+
+bool select::may_contain(std::string_view directory) const noexcept {
+    // Ancestors of anchor may contain anything below it
+    const bool is_ancestor = scope_anchor.starts_with(directory)
+            && scope_anchor[directory.size()] == '/';
+    if (scopes.empty() || is_ancestor) {
+        return true;
+    }
+
+    const auto relative = relative_to(directory, scope_anchor);
+    return relative && std::ranges::any_of(scopes, [&](const auto& scope) {
+               return reach(scope, *relative).has_value();
+           });
+}
+
+std::optional<std::vector<std::string>>
+select::subdirectories(std::string_view directory) const {
+    const auto relative = relative_to(directory, scope_anchor);
+    if (scopes.empty() || !relative) {
+        return std::nullopt;
+    }
+
+    auto names = std::vector<std::string>{};
+    for (const auto& scope : scopes) {
+        const auto index = reach(scope, *relative);
+        if (!index) {
+            continue;
+        }
+        // Files may be selected right here, or anywhere below
+        if (*index == std::string_view::npos || *index + 1 == scope.size()
+            || scope[*index].literal.empty()) {
+            return std::nullopt;
+        }
+        names.push_back(scope[*index].literal);
+    }
+    std::ranges::sort(names);
+    const auto [first, last] = std::ranges::unique(names);
+    names.erase(first, last);
+    return names;
+}
+
+decision
+select::apply(std::string_view path, bool is_directory) const noexcept {
+    const auto& items = is_directory ? dirs : files;
+    if (items.empty()) {
+        return decision::undecided;
+    }
+
+    const auto file = path.substr(path.rfind('/') + 1);
+    const auto match = [path, file](const auto& item) noexcept {
+        return item.regex(item.is_anchored ? path : file);
     };
     const auto it = std::ranges::find_if(items.rbegin(), items.rend(), match);
     if (it == items.rend()) {
-        return entry.is_directory() ? dirs_fallback : files_fallback;
+        return is_directory ? dirs_fallback : files_fallback;
     }
 
     return it->is_inverted ? decision::excluded : decision::included;
 }
 
+namespace {
+
+// Directory of cone pattern without escapes, nothing if it has wildcards
+std::optional<std::string> unescape_directory(std::string_view pattern) {
+    auto result = std::string{};
+    for (auto i = std::size_t{ 0 }; i < pattern.size(); i++) {
+        if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+            result += pattern[++i];
+        } else if (std::string_view{ "*?[" }.find(pattern[i])
+                   != std::string_view::npos) {
+            return std::nullopt;
+        } else {
+            result += pattern[i];
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+std::optional<cone> cone::parse(std::string_view patterns) {
+    auto result = cone{};
+    result.is_included = true;
+    for (const auto part : patterns | std::views::split('\n')) {
+        auto line = std::string_view{ part.begin(), part.end() };
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line.starts_with('#') || line == "/*") {
+            continue;
+        }
+        if (line == "!/*/") {
+            result.is_parent = true;
+            continue;
+        }
+
+        // Either `!/dir/*/` for parents, or `/dir/` for included directories
+        const bool is_parent = line.starts_with("!/") && line.ends_with("/*/");
+        const bool is_included = line.starts_with('/') && line.ends_with('/');
+        if (!is_parent && !is_included) {
+            return std::nullopt;
+        }
+        const auto directory = is_parent
+                ? unescape_directory(line.substr(2, line.size() - 5))
+                : unescape_directory(line.substr(1, line.size() - 2));
+        if (!directory || directory->empty()) {
+            return std::nullopt;
+        }
+        auto& added = result.add(*directory);
+        (is_parent ? added.is_parent : added.is_included) = true;
+    }
+    return result;
+}
+
+const cone* cone::subdirectory(std::string_view name) const {
+    if (is_recursive()) {
+        return this;
+    }
+    const auto it = std::ranges::lower_bound(children, name, {}, &cone::name);
+    return it != children.end() && it->name == name ? &*it : nullptr;
+}
+
+cone& cone::add(std::string_view directory) {
+    auto* current = this;
+    for (const auto name : split_path(directory)) {
+        auto& children = current->children;
+        auto it = std::ranges::lower_bound(children, name, {}, &cone::name);
+        if (it == children.end() || it->name != name) {
+            it = children.insert(it, cone{});
+            it->name = name;
+        }
+        current = &*it;
+    }
+    return *current;
+}
+
+typetags::typetags(
+        const std::unordered_map<std::string_view, std::string_view>& tags
+) {
+    tag_names = tags | std::views::keys
+            | backport::ranges::to<std::vector<std::string>>();
+    std::ranges::sort(tag_names);
+
+    const auto is_literal = [](std::string_view text) {
+        return text.find_first_of("*?[\\") == std::string_view::npos;
+    };
+    for (auto index = std::size_t{}; index < tag_names.size(); index++) {
+        for (const auto glob : glob::split(tags.at(tag_names[index]))) {
+            // Extension of `*.ext`, where `ext` has no wildcards nor dots
+            const bool is_extension = glob.starts_with("*.")
+                    && is_literal(glob.substr(2))
+                    && glob.find_first_of("./", 2) == std::string_view::npos;
+            if (is_extension) {
+                extensions[std::string{ glob.substr(2) }].push_back(index);
+            } else if (is_literal(glob)) {
+                exact[std::string{ glob }].push_back(index);
+            } else {
+                const auto pattern = glob::decompose(
+                        glob, glob::decompose_mode::select
+                ).pattern;
+                others.emplace_back(
+                        index, regex::engine{ glob::to_regex(pattern) }
+                );
+            }
+        }
+    }
+}
+
+void typetags::match(
+        std::string_view name, std::vector<std::size_t>& indices
+) const {
+    indices.clear();
+    const auto append = [&indices](const auto& map, std::string_view key) {
+        if (const auto it = map.find(key); it != map.end()) {
+            indices.insert(indices.end(), it->second.begin(), it->second.end());
+        }
+    };
+    if (const auto dot = name.rfind('.'); dot != std::string_view::npos) {
+        append(extensions, name.substr(dot + 1));
+    }
+    append(exact, name);
+    for (const auto& [index, regex] : others) {
+        if (regex(name)) {
+            indices.push_back(index);
+        }
+    }
+
+    std::ranges::sort(indices);
+    const auto [first, last] = std::ranges::unique(indices);
+    indices.erase(first, last);
+}
+
 }  // namespace glug::filter
 
@@ -1,15 +1,30 @@
 // Provided as part of glug under MIT license, (c) 2025-2026 Dominik Kaszewski
 #include "glug/filesystem.hpp"
+#include "glug/filter.hpp"
 #include "glug/regex.hpp"
 
 #include "glug/generated/license.hpp"
 
 #include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <format>
+#include <functional>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 using namespace std::string_view_literals;
@@ -59,6 +74,14 @@ Options:
   --version    print glug version
   --license    print license of glug and third-party libraries, if any
   --help-tags  print builtin tag expansions
+  --shard i/n  print only i-th of n disjoint parts of results, counting from 0
+  --newest n   print only n most recently modified files, newest first
+  --largest n  print only n largest files, largest first
+  --recurse-submodules
+               also search nested repositories, each with its own .gitignore
+  --stats-by=tag|dir
+               print count and bytes of files per tag or top-level directory,
+               instead of the files themselves
 
 Examples:
   glug . '*.cpp'               # Search all '*.cpp' files
@@ -66,6 +89,202 @@ Examples:
   glug test '#cpp,-#hpp'       # Search all cpp-related files except headers
 )"sv.substr(1);
 
+std::optional<std::size_t> parse_size(std::string_view number) {
+    auto result = std::size_t{};
+    const auto* const end = number.data() + number.size();
+    const auto [ptr, error] = std::from_chars(number.data(), end, result);
+    if (error != std::errc{} || ptr != end) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+// Parses `i/n` as in `--shard`, with `i < n`
+std::optional<glug::filesystem::explorer_shard>
+parse_shard(std::string_view value) {
+    const auto slash = value.find('/');
+    if (slash == std::string_view::npos) {
+        return std::nullopt;
+    }
+    const auto index = parse_size(value.substr(0, slash));
+    const auto count = parse_size(value.substr(slash + 1));
+    if (!index || !count || *index >= *count) {
+        return std::nullopt;
+    }
+    return glug::filesystem::explorer_shard{ .index = *index, .count = *count };
+}
+
+// Order of files kept by `--newest` and `--largest`
+enum class top_key : std::uint8_t { none, newest, largest };
+
+// Keeps `count` first files by `key` in a bounded heap, whose top is the last
+// of those kept, so that memory does not grow with the number of files
+std::vector<glug::filesystem::entry> top_files(
+        glug::filesystem::explorer& explorer, std::size_t count, top_key key
+) {
+    using glug::filesystem::entry;
+    const auto before = [key](const entry& lhs, const entry& rhs) {
+        if (key == top_key::newest
+            && lhs.last_write_time() != rhs.last_write_time()) {
+            return lhs.last_write_time() > rhs.last_write_time();
+        }
+        if (key == top_key::largest && lhs.file_size() != rhs.file_size()) {
+            return lhs.file_size() > rhs.file_size();
+        }
+        // Ties broken by path, so that output does not depend on walk order
+        return lhs < rhs;
+    };
+
+    auto heap = std::vector<entry>{};
+    auto batch = std::vector<entry>(256);
+    while (const auto read = explorer.next_batch(batch)) {
+        for (auto& file : std::span{ batch }.first(read)) {
+            if (heap.size() < count) {
+                heap.push_back(std::move(file));
+                std::ranges::push_heap(heap, before);
+            } else if (count > 0 && before(file, heap.front())) {
+                std::ranges::pop_heap(heap, before);
+                heap.back() = std::move(file);
+                std::ranges::push_heap(heap, before);
+            }
+        }
+    }
+    std::ranges::sort_heap(heap, before);
+    return heap;
+}
+
+// Files and their bytes counted by `--stats-by`
+struct totals {
+    std::size_t files{};
+    std::uintmax_t bytes{};
+
+    totals& operator+=(const totals& other) noexcept {
+        files += other.files;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+enum class stats_key : std::uint8_t { none, tag, dir };
+
+// Counts of files and their sizes, per tag or per directory
+struct stats_table {
+    totals total{};
+    // Indexed by tag, with untagged files last
+    std::vector<totals> by_tag{};
+    std::map<std::filesystem::path::string_type, totals, std::less<>> by_dir{};
+};
+
+using native_view = std::basic_string_view<std::filesystem::path::value_type>;
+
+// Directory directly in root leading to directory of file, empty for root
+native_view
+top_directory(const std::filesystem::path& directory, std::size_t root) {
+    const auto& native = directory.native();
+    if (native.size() <= root) {
+        return {};
+    }
+    const auto rest = native_view{ native }.substr(root);
+    const auto end = std::ranges::find_if(rest, [](auto c) {
+        return c == '/' || c == std::filesystem::path::preferred_separator;
+    });
+    return rest.substr(0, end - rest.begin());
+}
+
+// Counts files without building any strings from their paths
+void count_files(
+        const std::filesystem::path& root,
+        const glug::filesystem::explorer_options& options,
+        stats_key key,
+        const glug::filter::typetags& classifier,
+        stats_table& table
+) {
+    // Directories below root are `root / name`, so this is where names start
+    const auto root_length = (root / "").native().size();
+
+    table.by_tag.resize(classifier.names().size() + 1);
+    auto indices = std::vector<std::size_t>{};
+    const auto count = [&](const auto& file) {
+        const auto counted = totals{ .files = 1, .bytes = file.size };
+        table.total += counted;
+        if (key == stats_key::dir) {
+            const auto directory = top_directory(file.directory, root_length);
+            auto it = table.by_dir.find(directory);
+            if (it == table.by_dir.end()) {
+                it = table.by_dir.emplace(directory, totals{}).first;
+            }
+            it->second += counted;
+            return;
+        }
+
+        if constexpr (std::is_same_v<
+                              std::filesystem::path::value_type,
+                              char>) {
+            classifier.match(file.name, indices);
+        } else {
+            classifier.match(
+                    std::filesystem::path{ file.name }.string(), indices
+            );
+        }
+        if (indices.empty()) {
+            table.by_tag.back() += counted;
+        }
+        for (const auto index : indices) {
+            table.by_tag[index] += counted;
+        }
+    };
+    auto explorer = glug::filesystem::explorer{ root, options };
+    explorer.visit_batch(std::numeric_limits<std::size_t>::max(), count);
+}
+
+// Reads ahead on all cores, leaving only counting to the calling thread
+int print_stats(
+        const std::filesystem::path& root,
+        const glug::filesystem::explorer_options& options,
+        stats_key key
+) {
+    const auto classifier = glug::filter::typetags{ tags };
+    auto threaded = options;
+    threaded.threads = std::max(std::thread::hardware_concurrency(), 1U);
+    auto table = stats_table{};
+    count_files(root, threaded, key, classifier, table);
+
+    auto rows = std::vector<std::pair<std::string, totals>>{};
+    if (key == stats_key::tag) {
+        for (auto i = std::size_t{}; i < classifier.names().size(); i++) {
+            if (table.by_tag[i].files > 0) {
+                rows.emplace_back(classifier.names()[i], table.by_tag[i]);
+            }
+        }
+        if (table.by_tag.back().files > 0) {
+            rows.emplace_back("(none)", table.by_tag.back());
+        }
+    } else {
+        for (const auto& [directory, counted] : table.by_dir) {
+            const auto name = std::filesystem::path{ directory };
+            rows.emplace_back(
+                    directory.empty() ? "." : name.generic_string(), counted
+            );
+        }
+    }
+    rows.emplace_back("total", table.total);
+
+    const auto max_elem = std::ranges::max_element(
+            rows, {}, [](const auto& row) { return row.first.size(); }
+    );
+    const auto pad = std::max<std::size_t>(max_elem->first.size(), 9);
+    println("{:{}}  {:>10}  {:>14}",
+            key == stats_key::tag ? "tag" : "directory",
+            pad,
+            "files",
+            "bytes");
+    for (const auto& [name, counted] : rows) {
+        const auto& [files, bytes] = counted;
+        println("{:{}}  {:>10}  {:>14}", name, pad, files, bytes);
+    }
+    return 0;
+}
+
 int print_help() {
     print("{}", help);
     return 0;
@@ -105,7 +324,7 @@ int main(int argc, const char** argv) {
     using namespace std::string_view_literals;
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    const auto args = std::vector<std::string_view>{ argv, argv + argc };
+    auto args = std::vector<std::string_view>{ argv, argv + argc };
     const auto has_option = [&args](std::string_view option) {
         return std::ranges::find(args, option) != args.end();
     };
@@ -125,16 +344,90 @@ int main(int argc, const char** argv) {
         return print_tags();
     }
 
+    auto shard = glug::filesystem::explorer_shard{};
+    if (const auto it = std::ranges::find(args, "--shard"); it != args.end()) {
+        const auto value = std::next(it) != args.end() ? *std::next(it) : ""sv;
+        const auto parsed = parse_shard(value);
+        if (!parsed) {
+            std::cerr << "glug: expected --shard i/n with i < n\n";
+            return 2;
+        }
+        shard = *parsed;
+        args.erase(it, std::next(it, 2));
+    }
+
+    auto top = top_key::none;
+    auto top_count = std::size_t{};
+    for (const auto& [option, key] : {
+                 std::pair{ "--newest"sv, top_key::newest },
+                 std::pair{ "--largest"sv, top_key::largest },
+         }) {
+        const auto it = std::ranges::find(args, option);
+        if (it == args.end()) {
+            continue;
+        }
+        const auto value = std::next(it) != args.end() ? *std::next(it) : ""sv;
+        const auto parsed = parse_size(value);
+        if (!parsed || top != top_key::none) {
+            std::cerr << "glug: expected one of --newest n or --largest n\n";
+            return 2;
+        }
+        top = key;
+        top_count = *parsed;
+        args.erase(it, std::next(it, 2));
+    }
+
+    auto stats = stats_key::none;
+    const auto is_stats = [](std::string_view arg) {
+        return arg.starts_with("--stats-by=");
+    };
+    const auto stats_arg = std::ranges::find_if(args, is_stats);
+    if (stats_arg != args.end()) {
+        const auto value = stats_arg->substr(stats_arg->find('=') + 1);
+        stats = value == "tag" ? stats_key::tag
+                : value == "dir" ? stats_key::dir
+                                 : stats_key::none;
+        if (stats == stats_key::none || top != top_key::none) {
+            std::cerr << "glug: expected --stats-by=tag or --stats-by=dir, "
+                         "without --newest or --largest\n";
+            return 2;
+        }
+        args.erase(stats_arg);
+    }
+
+    const auto nested = std::ranges::find(args, "--recurse-submodules");
+    const bool nested_repositories = nested != args.end();
+    if (nested_repositories) {
+        args.erase(nested);
+    }
+
     const auto dir = args.size() > 1 ? args[1] : "."sv;
     const auto select = args.size() > 2 ? args[2] : ""sv;
     const auto db = glug::glob::typetag_database{ tags };
-    const auto explorer = glug::filesystem::explorer{
-        dir, { glug::filter::select{ db.expand(select), dir } }
+    const auto options = glug::filesystem::explorer_options{
+        .select = glug::filter::select{ db.expand(select), dir },
+        .metadata = top != top_key::none || stats != stats_key::none,
+        .nested_repositories = nested_repositories,
+        .shard = shard,
     };
+    if (stats != stats_key::none) {
+        return print_stats(dir, options, stats);
+    }
+
+    auto explorer = glug::filesystem::explorer{ dir, options };
 
     const auto trim_dot = dir == "." ? 2 : 0;
-    for (const auto& file : explorer) {
+    const auto print_file = [trim_dot](const auto& file) {
         println("{}", file.path().generic_string().substr(trim_dot));
+    };
+    if (top != top_key::none) {
+        std::ranges::for_each(top_files(explorer, top_count, top), print_file);
+        return 0;
+    }
+
+    auto batch = std::vector<glug::filesystem::entry>(256);
+    while (const auto count = explorer.next_batch(batch)) {
+        std::ranges::for_each(std::span{ batch }.first(count), print_file);
     }
     return 0;
 }
@@ -8,7 +8,12 @@
 #include <hs/hs_compile.h>
 #include <hs/hs_runtime.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -26,12 +31,16 @@ struct impl {
         void operator()(hs_scratch* p) const { hs_free_scratch(p); }
     };
 
-    impl(hs_database* db, hs_scratch* scratch) :
-        db{ db, {} },
-        scratch{ scratch, {} } {}
+    explicit impl(hs_database* db) :
+        db{ db, {} } {}
 
     std::unique_ptr<hs_database, database_deleter> db{};
-    std::unique_ptr<hs_scratch, scratch_deleter> scratch{};
+    // Tells databases apart for scratch, unlike address which may be reused.
+    // Starts from 1, so that 0 marks an unused slot.
+    std::uint64_t serial{ next_serial++ };
+
+    private:
+    static inline auto next_serial = std::atomic<std::uint64_t>{ 1 };
 };
 
 }  // namespace detail
@@ -49,11 +58,7 @@ engine::engine(std::string_view pattern) {
             &error
     );
     assert(result == HS_SUCCESS);
-
-    auto* scratch = std::type_identity_t<hs_scratch*>{};
-    result = hs_alloc_scratch(db, &scratch);
-    assert(result == HS_SUCCESS);
-    pimpl = std::make_shared<detail::impl>(db, scratch);
+    pimpl = std::make_shared<detail::impl>(db);
 }
 
 bool engine::match(std::string_view s) const {
@@ -61,16 +66,37 @@ bool engine::match(std::string_view s) const {
         return false;
     }
 
+    // Scratch cannot be used by multiple threads at once, so keep one per
+    // thread, grown to fit every database it is used with. Only the most
+    // recently seen databases are remembered, as every ignore rule is one;
+    // growing for a forgotten one again only finds the scratch big enough.
+    struct thread_scratch {
+        std::unique_ptr<hs_scratch, detail::impl::scratch_deleter> scratch{};
+        std::array<std::uint64_t, 64> databases{};
+        std::size_t next{};
+    };
+    thread_local auto local = thread_scratch{};
+    if (std::ranges::find(local.databases, pimpl->serial)
+        == local.databases.end()) {
+        local.databases[local.next] = pimpl->serial;
+        local.next = (local.next + 1) % local.databases.size();
+        auto* raw_scratch = local.scratch.release();
+        [[maybe_unused]] const auto allocated
+                = hs_alloc_scratch(pimpl->db.get(), &raw_scratch);
+        local.scratch.reset(raw_scratch);
+        assert(allocated == HS_SUCCESS);
+    }
+
     auto found = false;
     const auto handler = [](auto, auto, auto, auto, void* found) -> int {
         return *static_cast<bool*>(found) = true;
     };
-    [[maybe_unused]] auto result = hs_scan(
+    [[maybe_unused]] const auto result = hs_scan(
             pimpl->db.get(),
             s.data(),
             static_cast<unsigned int>(s.size()),
             0,
-            pimpl->scratch.get(),
+            local.scratch.get(),
             handler,
             &found
     );
@@ -27,7 +27,6 @@ struct impl {
     };
 
     std::unique_ptr<pcre2_code_8, code_deleter> code{};
-    std::unique_ptr<pcre2_match_data_8, scratch_deleter> scratch{};
 };
 
 }  // namespace detail
@@ -52,13 +51,7 @@ engine::engine(std::string_view pattern) :
     };
     if (!pimpl->code) {
         pimpl = nullptr;
-        return;
     }
-
-    pimpl->scratch = {
-        pcre2_match_data_create_from_pattern(pimpl->code.get(), nullptr),
-        {},
-    };
 }
 
 bool engine::match(std::string_view s) const {
@@ -66,6 +59,15 @@ bool engine::match(std::string_view s) const {
         return false;
     }
 
+    // Match data is written to, so it cannot be shared between threads.
+    // Only the overall match is needed, so a single pair is always enough.
+    using deleter = detail::impl::scratch_deleter;
+    thread_local const auto scratch
+            = std::unique_ptr<pcre2_match_data_8, deleter>{
+                  pcre2_match_data_create_8(1, nullptr),
+                  {},
+              };
+
     const auto matches = pcre2_match_8(
             pimpl->code.get(),
             // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
@@ -73,7 +75,7 @@ bool engine::match(std::string_view s) const {
             s.size(),
             0,
             PCRE2_ANCHORED | PCRE2_ENDANCHORED,
-            pimpl->scratch.get(),
+            scratch.get(),
             nullptr
     );
     return matches >= 0;
@@ -0,0 +1,127 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/filesystem.hpp"
+#include "glug/filesystem/memory.hpp"
+#include "glug/filter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto directories = std::size_t{ 64 };
+constexpr auto files_per_directory = std::size_t{ 512 };
+constexpr auto repetitions = 5;
+
+struct scenario {
+    std::string_view name{};
+    glug::filesystem::explorer_options options{};
+    bool gitignore{};
+};
+
+void write_file(const fs::path& path, std::string_view contents = {}) {
+    auto stream = std::ofstream{ path, std::ios::binary };
+    stream << contents;
+}
+
+// Wide and shallow, so that time is spent filtering rather than descending
+void make_tree(const fs::path& root) {
+    fs::create_directories(root / ".git");
+    for (auto i = std::size_t{ 0 }; i < directories; i++) {
+        const auto directory = root / ("dir" + std::to_string(i));
+        fs::create_directories(directory / "build");
+        write_file(directory / "build" / "out.o");
+        for (auto j = std::size_t{ 0 }; j < files_per_directory; j++) {
+            const auto extension = j % 4 == 0 ? ".log" : ".cpp";
+            write_file(directory / ("file" + std::to_string(j) + extension));
+        }
+    }
+}
+
+// Best of several runs, as the first one also warms up the cache
+auto measure(
+        const fs::path& root, const glug::filesystem::explorer_options& options
+) {
+    auto best = std::chrono::nanoseconds::max();
+    auto count = std::ptrdiff_t{};
+    for (auto i = 0; i < repetitions; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        auto explorer = glug::filesystem::explorer{ root, options };
+        count = std::ranges::distance(explorer, glug::filesystem::explorer{});
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+    return std::pair{ best, count };
+}
+
+void print_time(std::chrono::nanoseconds time, std::ptrdiff_t count) {
+    const auto ns = time.count();
+    std::cout << std::setw(12) << ns / 1e6 << std::setw(12)
+              << ns / std::max<std::ptrdiff_t>(count, 1);
+}
+
+}  // namespace
+
+int main() {
+    const auto root = fs::temp_directory_path() / "glug_benchmark";
+    fs::remove_all(root);
+    make_tree(root);
+
+    const auto prune_build
+            = [](const fs::path& path) { return path.filename() == "build"; };
+    const auto scenarios = std::vector<scenario>{
+        { "plain", {} },
+        { "ignore", {}, true },
+        { "select", { .select = glug::filter::select{ "*.cpp" } } },
+        { "prune", { .prune = prune_build } },
+        {
+            "all",
+            {
+                .select = glug::filter::select{ "*.cpp" },
+                .prune = prune_build,
+            },
+            true,
+        },
+    };
+
+    // Same tree in memory, measuring filtering alone without any I/O
+    std::cout << std::left << std::setw(10) << "scenario" << std::right
+              << std::setw(10) << "files" << std::setw(12) << "ms"
+              << std::setw(12) << "ns/file" << std::setw(12) << "memory ms"
+              << std::setw(12) << "ns/file" << "\n";
+    for (const auto& scenario : scenarios) {
+        if (scenario.gitignore) {
+            write_file(root / ".gitignore", "*.log\n");
+        } else {
+            fs::remove(root / ".gitignore");
+        }
+
+        const auto [time, count] = measure(root, scenario.options);
+        auto options = scenario.options;
+        options.source = std::make_shared<const glug::filesystem::memory_tree>(
+                glug::filesystem::memory_tree::record(root)
+        );
+        const auto [memory_time, memory_count] = measure("/", options);
+
+        std::cout << std::left << std::setw(10) << scenario.name << std::right
+                  << std::setw(10) << count << std::fixed
+                  << std::setprecision(2);
+        print_time(time, count);
+        print_time(memory_time, memory_count);
+        std::cout << "\n";
+    }
+
+    fs::remove_all(root);
+    return 0;
+}
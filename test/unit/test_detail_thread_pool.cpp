@@ -0,0 +1,92 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/detail/thread_pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace glug::detail::unit_test {
+
+// NOLINTNEXTLINE
+TEST(thread_pool_test, runs_nested_tasks) {
+    static constexpr auto depth = 10;
+    auto done = std::promise<void>{};
+    auto count = std::atomic<std::size_t>{};
+    auto pool = thread_pool{ 4 };
+
+    // Binary tree of tasks, each leaf counting itself
+    auto spawn = std::function<void(int)>{};
+    spawn = [&](int level) {
+        if (level == depth) {
+            if (++count == std::size_t{ 1 } << depth) {
+                done.set_value();
+            }
+            return;
+        }
+        pool.submit([&spawn, level] { spawn(level + 1); });
+        pool.submit([&spawn, level] { spawn(level + 1); });
+    };
+    pool.submit([&spawn] { spawn(0); });
+
+    done.get_future().wait();
+    EXPECT_EQ(count, std::size_t{ 1 } << depth);
+}
+
+// NOLINTNEXTLINE
+TEST(thread_pool_test, uses_all_workers) {
+    static constexpr auto threads = std::size_t{ 3 };
+    auto mutex = std::mutex{};
+    auto ids = std::set<std::thread::id>{};
+    auto arrived = std::atomic<std::size_t>{};
+    auto done = std::promise<void>{};
+    auto pool = thread_pool{ threads };
+    EXPECT_EQ(pool.size(), threads);
+
+    // Each task blocks until all have started, so must run on separate workers
+    for (auto i = std::size_t{ 0 }; i < threads; i++) {
+        pool.submit([&] {
+            {
+                const auto lock = std::scoped_lock{ mutex };
+                ids.insert(std::this_thread::get_id());
+            }
+            if (++arrived == threads) {
+                done.set_value();
+            }
+            while (arrived < threads) {
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    done.get_future().wait();
+    const auto lock = std::scoped_lock{ mutex };
+    EXPECT_EQ(ids.size(), threads);
+}
+
+// NOLINTNEXTLINE
+TEST(thread_pool_test, stops_with_queued_tasks) {
+    auto count = std::atomic<std::size_t>{};
+    {
+        auto pool = thread_pool{ 1 };
+        auto release = std::promise<void>{};
+        auto started = std::promise<void>{};
+        pool.submit([&started, future = release.get_future().share()] {
+            started.set_value();
+            future.wait();
+        });
+        started.get_future().wait();
+        for (auto i = 0; i < 100; i++) {
+            pool.submit([&count] { count++; });
+        }
+        release.set_value();
+    }
+    EXPECT_LE(count, std::size_t{ 100 });
+}
+
+}  // namespace glug::detail::unit_test
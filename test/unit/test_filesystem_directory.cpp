@@ -0,0 +1,233 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/filesystem/directory.hpp"
+
+#include "tree.hpp"
+
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace glug::filesystem::unit_test {
+
+using glug::unit_test::dir;
+using glug::unit_test::file;
+using glug::unit_test::temp_fs;
+using glug::unit_test::operator""_d;
+using glug::unit_test::operator""_f;
+using std::filesystem::file_type;
+using path_char = std::filesystem::path::value_type;
+
+namespace {
+
+auto read_all(directory_reader& reader) {
+    auto result = std::vector<std::pair<std::filesystem::path, file_type>>{};
+    while (const auto raw = reader.next()) {
+        result.emplace_back(raw->name, raw->type);
+    }
+    return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, lists_names_and_types) {
+    const auto tree = dir{ "listing", { "README.md"_f, "src"_d } };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+
+    auto reader = directory_reader{ temp / tree.path() };
+    ASSERT_TRUE(reader.is_open());
+    EXPECT_THAT(
+            read_all(reader),
+            testing::UnorderedElementsAre(
+                    testing::Pair("README.md", file_type::regular),
+                    testing::Pair("src", file_type::directory)
+            )
+    );
+    EXPECT_FALSE(reader.next());
+}
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, opens_child) {
+    const auto tree = "parent"_d / ("child"_d / "main.c"_f);
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+
+    const auto parent = directory_reader{ temp / tree.path() };
+    auto child = directory_reader{ parent, "child" };
+    EXPECT_THAT(
+            read_all(child),
+            testing::ElementsAre(testing::Pair("main.c", testing::_))
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, probes_and_reads_files) {
+    const auto tree = dir{
+        "probes",
+        {
+            file{ ".gitignore", "*.log\r\n" },
+            ".git"_d,
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+
+    const auto reader = directory_reader{ temp / tree.path() };
+    EXPECT_TRUE(reader.contains(".git"));
+    EXPECT_TRUE(reader.contains(".gitignore"));
+    EXPECT_FALSE(reader.contains("missing"));
+    EXPECT_EQ(reader.type(".git"), file_type::directory);
+    EXPECT_EQ(reader.type(".gitignore"), file_type::regular);
+    EXPECT_EQ(reader.type("missing"), file_type::not_found);
+    EXPECT_EQ(reader.read(".gitignore"), "*.log\r\n");
+    EXPECT_EQ(reader.read("missing"), "");
+    EXPECT_EQ(reader.read(".git"), "");
+}
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, queries_status) {
+    const auto tree = dir{
+        "status",
+        {
+            file{ "data.bin", "12345" },
+            "src"_d,
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+
+    const auto reader = directory_reader{ temp / tree.path() };
+    const auto paths = std::vector<std::filesystem::path>{
+        "data.bin",
+        "src",
+        "missing",
+    };
+    auto names = std::vector<const path_char*>{};
+    for (const auto& path : paths) {
+        names.push_back(path.c_str());
+    }
+    const auto statuses = reader.status(names);
+    ASSERT_EQ(statuses.size(), names.size());
+    EXPECT_EQ(statuses[0].type, file_type::regular);
+    EXPECT_EQ(statuses[0].size, 5);
+    EXPECT_EQ(
+            statuses[0].last_write_time,
+            std::filesystem::last_write_time(temp / tree.path() / "data.bin")
+    );
+    EXPECT_EQ(statuses[1].type, file_type::directory);
+    EXPECT_EQ(statuses[2].type, file_type::not_found);
+
+    // Single entries and batches larger than one submission
+    EXPECT_EQ(reader.status({ names.data(), 1 }).at(0).size, 5);
+    const auto many = std::vector<const path_char*>(200, names[0]);
+    for (const auto& status : reader.status(many)) {
+        EXPECT_EQ(status.size, 5);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, queries_status_of_large_listings) {
+    // Larger than a single ring, with sizes telling the entries apart
+    static constexpr auto count = 150;
+    const auto temp = temp_fs{};
+    auto paths = std::vector<std::filesystem::path>{};
+    for (auto i = 0; i < count; i++) {
+        const auto name = "file_" + std::to_string(i);
+        file{ name, std::string(static_cast<std::size_t>(i), 'x') }
+                .materialize(temp);
+        paths.emplace_back(name);
+    }
+    auto names = std::vector<const path_char*>{};
+    for (const auto& path : paths) {
+        names.push_back(path.c_str());
+    }
+
+    // Repeated, so entries left over from one batch would spill into next,
+    // also with submits limited to force several `io_uring_enter` per batch
+    const auto reader = directory_reader{ temp };
+    for (const auto limit : { 0U, 7U }) {
+        detail::limit_submissions(limit);
+        for (auto round = 0; round < 3; round++) {
+            const auto statuses = reader.status(names);
+            ASSERT_EQ(statuses.size(), names.size());
+            for (auto i = 0; i < count; i++) {
+                EXPECT_EQ(statuses[i].type, file_type::regular);
+                EXPECT_EQ(statuses[i].size, i);
+            }
+        }
+    }
+    detail::limit_submissions(0);
+}
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, follows_symlinks) {
+    const auto tree = dir{
+        "links",
+        {
+            "real"_d / file{ "data.bin", "12345" },
+            glug::unit_test::link{ "alias", "real" },
+            glug::unit_test::link{ "data.lnk", "real/data.bin" },
+        },
+    };
+    const auto temp = temp_fs{};
+    try {
+        tree.materialize(temp);
+    } catch (const std::filesystem::filesystem_error& e) {
+        GTEST_SKIP() << e.what();
+    }
+
+    const auto parent = directory_reader{ temp / tree.path() };
+    const auto real = directory_reader{ parent, "real" };
+    const auto alias = directory_reader{ parent, "alias", true };
+    EXPECT_EQ(real.id(), alias.id());
+    EXPECT_NE(real.id(), parent.id());
+
+    const auto link = std::filesystem::path{ "data.lnk" };
+    const auto names = std::vector<const path_char*>{ link.c_str() };
+    EXPECT_EQ(parent.status(names).at(0).type, file_type::symlink);
+    EXPECT_EQ(parent.status(names, true).at(0).type, file_type::regular);
+    EXPECT_EQ(parent.status(names, true).at(0).size, 5);
+}
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, throws_on_missing) {
+    const auto temp = temp_fs{};
+    EXPECT_THROW(
+            directory_reader{ temp.path() / "missing" },
+            std::filesystem::filesystem_error
+    );
+
+    const auto parent = directory_reader{ temp };
+    EXPECT_THROW(
+            (directory_reader{ parent, "missing" }),
+            std::filesystem::filesystem_error
+    );
+
+    // Error names the whole path, not just the name within parent
+    try {
+        std::ignore = directory_reader{ parent, "missing" };
+    } catch (const std::filesystem::filesystem_error& e) {
+        EXPECT_EQ(e.path1(), temp.path() / "missing");
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(directory_reader_test, reads_large_directories) {
+    static constexpr auto count = 2000;
+    const auto temp = temp_fs{};
+    for (auto i = 0; i < count; i++) {
+        file{ "file_with_quite_a_long_name_" + std::to_string(i) }
+                .materialize(temp);
+    }
+
+    auto reader = directory_reader{ temp };
+    EXPECT_EQ(read_all(reader).size(), count);
+}
+
+}  // namespace glug::filesystem::unit_test
@@ -2,15 +2,36 @@
 #include "glug/filesystem.hpp"
 
 #include "glug/backport/ranges.hpp"
+#include "glug/detail/thread_pool.hpp"
+#include "glug/filesystem/async.hpp"
+#include "glug/filesystem/memory.hpp"
 
+#include "parametrized.hpp"
 #include "tree.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <ostream>
 #include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -41,6 +62,46 @@ struct explorer_param {
 
 class explorer_test : public testing::TestWithParam<explorer_param> {};
 
+// Walks the same tree in each mode of the explorer
+class explorer_mode_test : public testing::TestWithParam<explorer_options> {};
+
+// NOLINTNEXTLINE
+INSTANTIATE_TEST_SUITE_P(
+        explorer_mode_test,
+        explorer_mode_test,
+        values_in<explorer_options>({
+            {},
+            { .threads = 4 },
+            { .lookahead = 1 },
+            { .unordered = true },
+        }),
+        [](const auto& info) {
+            const auto& options = info.param;
+            return options.threads > 0 ? std::string{ "parallel" }
+                    : options.lookahead > 0 ? std::string{ "lookahead" }
+                    : options.unordered     ? std::string{ "unordered" }
+                                            : std::string{ "sequential" };
+        }
+);
+
+namespace {
+
+// Only unordered mode may return entries in another order
+template <typename Actual, typename Expected>
+void expect_walk(
+        const explorer_options& options,
+        const Actual& actual,
+        const Expected& expected
+) {
+    if (options.unordered) {
+        EXPECT_THAT(actual, testing::UnorderedElementsAreArray(expected));
+    } else {
+        EXPECT_THAT(actual, testing::ElementsAreArray(expected));
+    }
+}
+
+}  // namespace
+
 // NOLINTNEXTLINE
 TEST_F(explorer_test, iterators) {
     auto tree = "iterators"_d / "README.md"_f;
@@ -69,8 +130,458 @@ TEST_F(explorer_test, dereference) {
 }
 
 // NOLINTNEXTLINE
-TEST_P(explorer_test, test) {
-    const auto& [tree, expected, target, select] = GetParam();
+TEST_P(explorer_mode_test, copies) {
+    auto tree = dir{
+        "copies",
+        {
+            "README.md"_f,
+            "docs"_d / "index.md"_f,
+            dir{ "src", { "lib"_d / "lib.c"_f, "main.c"_f } },
+        },
+    };
+    const auto& options = GetParam();
+    if (options.unordered) {
+        GTEST_SKIP() << "Copies in unordered mode share the open directory";
+    }
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    auto exp = explorer{ temp / tree.path(), options };
+    const auto all = std::vector<entry>(exp, explorer{});
+    ASSERT_EQ(all.size(), 4);
+
+    // Copies share levels, but each advances on its own
+    const auto copy = std::next(exp, 2);
+    EXPECT_EQ(*copy, all[2]);
+    EXPECT_EQ(*exp, all[0]);
+    EXPECT_EQ(std::next(copy), std::next(exp, 3));
+    EXPECT_NE(copy, exp);
+    EXPECT_THAT(
+            std::vector<entry>(copy, explorer{}),
+            testing::ElementsAre(all[2], all[3])
+    );
+    EXPECT_EQ(std::vector<entry>(exp, explorer{}), all);
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, next_batch) {
+    auto tree = dir{
+        "next_batch",
+        {
+            "README.md"_f,
+            "docs"_d / "index.md"_f,
+            dir{ "src", { "lib"_d / "lib.c"_f, "main.c"_f, "main.h"_f } },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto& options = GetParam();
+    const auto all = std::vector<entry>(
+            explorer{ temp / tree.path(), options }, explorer{}
+    );
+    ASSERT_EQ(all.size(), 5);
+
+    // Batches span directories, only the last one is partially filled
+    for (const auto size : std::vector<std::size_t>{ 1, 2, 5, 8 }) {
+        auto exp = explorer{ temp / tree.path(), options };
+        auto batch = std::vector<entry>(size);
+        auto actual = std::vector<entry>{};
+        while (const auto count = exp.next_batch(batch)) {
+            std::ranges::copy(
+                    std::span{ batch }.first(count), std::back_inserter(actual)
+            );
+            EXPECT_TRUE(count == size || exp == explorer{});
+        }
+        expect_walk(options, actual, all);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, visit_batch) {
+    auto tree = dir{
+        "visit_batch",
+        {
+            file{ "README.md", "12345" },
+            "docs"_d / "index.md"_f,
+            dir{ "src", { "lib"_d / "lib.c"_f, "main.c"_f, "main.h"_f } },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    auto options = GetParam();
+    options.metadata = true;
+    const auto all = std::vector<entry>(
+            explorer{ temp / tree.path(), options }, explorer{}
+    );
+    ASSERT_EQ(all.size(), 5);
+
+    // Same entries as `next_batch`, put together from directory and name
+    for (const auto limit : std::vector<std::size_t>{ 1, 2, 5, 8 }) {
+        auto exp = explorer{ temp / tree.path(), options };
+        auto actual = std::vector<std::filesystem::path>{};
+        auto sizes = std::vector<std::uintmax_t>{};
+        const auto visit = [&](const entry_view& view) {
+            actual.push_back(view.directory / view.name);
+            sizes.push_back(view.size);
+            EXPECT_EQ(view.type, std::filesystem::file_type::regular);
+        };
+        while (const auto count = exp.visit_batch(limit, visit)) {
+            EXPECT_TRUE(count == limit || exp == explorer{});
+        }
+        expect_walk(options, actual, all);
+        const auto readme
+                = std::ranges::find(actual, temp / tree.path() / "README.md");
+        ASSERT_NE(readme, actual.end());
+        EXPECT_EQ(sizes[readme - actual.begin()], 5);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, prune) {
+    auto tree = dir{
+        "prune",
+        {
+            "README.md"_f,
+            "build"_d / "out.o"_f,
+            dir{ "src", { "build"_d / "gen.c"_f, "main.c"_f } },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+    auto options = GetParam();
+    options.prune = [](const std::filesystem::path& path) {
+        return path.filename() == "build";
+    };
+    auto exp = explorer{ root, options };
+    expect_walk(
+            options,
+            std::vector<entry>(exp, explorer{}),
+            std::vector{ root / "README.md", root / "src/main.c" }
+    );
+    // Neither of pruned directories is read
+    EXPECT_EQ(exp.stats().entries, 5);
+}
+
+namespace {
+
+auto make_checkpoint_tree() {
+    return dir{
+        "checkpoint",
+        {
+            file{ ".gitignore", "*.log" },
+            "README.md"_f,
+            "build.log"_f,
+            "docs"_d / "index.md"_f,
+            dir{
+                "src",
+                {
+                    "lib"_d / "lib.c"_f,
+                    "debug.log"_f,
+                    "main.c"_f,
+                    "main.h"_f,
+                },
+            },
+        },
+    };
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, checkpoint) {
+    const auto tree = make_checkpoint_tree();
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+    const auto roots = std::vector{ root / "src", root / "docs" };
+    const auto& options = GetParam();
+    if (options.unordered) {
+        GTEST_SKIP() << "Unordered mode cannot be checkpointed";
+    }
+    const auto all = std::vector<entry>(explorer{ roots, options }, {});
+    ASSERT_EQ(all.size(), 4);
+
+    // Rules above roots apply again, without storing them
+    for (auto i = std::size_t{ 0 }; i <= all.size(); i++) {
+        const auto blob = std::next(explorer{ roots, options }, i).checkpoint();
+        EXPECT_THAT(
+                std::vector<entry>(explorer::restore(blob, options), {}),
+                testing::ElementsAreArray(std::span{ all }.subspan(i))
+        );
+    }
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, checkpoint) {
+    const auto tree = make_checkpoint_tree();
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+
+    // Resumes from the next entry if the current one was removed
+    auto exp = std::next(explorer{ root }, 3);
+    ASSERT_EQ(exp->path(), root / "src/main.c");
+    const auto blob = exp.checkpoint();
+    std::filesystem::remove(root / "src/main.c");
+    EXPECT_THAT(
+            std::vector<entry>(explorer::restore(blob), {}),
+            testing::ElementsAre(root / "src/main.h", root / "src/lib/lib.c")
+    );
+
+    // Only the root is stored whole, levels below by their name
+    EXPECT_NE(blob.find(root.string()), std::string::npos);
+    EXPECT_EQ(blob.find((root / "src").string()), std::string::npos);
+
+    EXPECT_EQ(explorer::restore(explorer{}.checkpoint()), explorer{});
+    const auto unordered = explorer{ root, { .unordered = true } };
+    EXPECT_THROW(std::ignore = unordered.checkpoint(), std::logic_error);
+    EXPECT_THROW(
+            std::ignore = explorer::restore(blob, { .unordered = true }),
+            std::logic_error
+    );
+    EXPECT_THROW(
+            std::ignore = explorer::restore(blob.substr(0, blob.size() - 1)),
+            std::invalid_argument
+    );
+    EXPECT_THROW(
+            std::ignore = explorer::restore(std::string{ blob } + "x"),
+            std::invalid_argument
+    );
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, checkpoint_after_prune) {
+    const auto tree = dir{
+        "checkpoint_after_prune",
+        {
+            dir{ "a", { "x.c"_f, "m"_d / "1.c"_f, "n"_d / "2.c"_f } },
+            "b"_d / "y.c"_f,
+        },
+    };
+    const auto& options = GetParam();
+    if (options.unordered) {
+        GTEST_SKIP() << "Unordered mode cannot be checkpointed";
+    }
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+    auto exp = explorer{ root, options };
+    ASSERT_EQ(exp->path(), root / "a/x.c");
+    exp.disable_recursion_pending();
+    const auto restored = explorer::restore(exp.checkpoint(), options);
+    EXPECT_THAT(
+            std::vector<entry>(restored, {}),
+            testing::ElementsAre(root / "a/x.c", root / "b/y.c")
+    );
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, checkpoint_after_symlink) {
+    // Link is walked after the directory it points to is left
+    const auto tree = dir{
+        "checkpoint_after_symlink",
+        {
+            "a"_d / "x.c"_f,
+            "m"_d / "n.c"_f,
+            link{ "z", "a" },
+        },
+    };
+    auto options = GetParam();
+    if (options.unordered) {
+        GTEST_SKIP() << "Unordered mode cannot be checkpointed";
+    }
+    options.follow_symlinks = true;
+    const auto temp = temp_fs{};
+    try {
+        tree.materialize(temp);
+    } catch (const std::filesystem::filesystem_error& e) {
+        GTEST_SKIP() << e.what();
+    }
+    const auto root = temp / tree.path();
+    const auto exp = std::next(explorer{ root, options });
+    ASSERT_EQ(exp->path(), root / "m/n.c");
+    const auto restored = explorer::restore(exp.checkpoint(), options);
+    EXPECT_THAT(
+            std::vector<entry>(restored, {}),
+            testing::ElementsAre(root / "m/n.c")
+    );
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, shard) {
+    auto tree = dir{
+        "shard",
+        {
+            "a.txt"_f,
+            "b.txt"_f,
+            "c.txt"_f,
+            dir{ "d1", { "x"_f, "y"_f } },
+            dir{ "d2", { "x"_f, "y"_f } },
+            dir{ "d3", { "x"_f, "y"_f } },
+            dir{ "d4", { "x"_f, "y"_f } },
+            dir{ "d5", { "x"_f, "y"_f } },
+            dir{ "d6", { "x"_f, "y"_f } },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+    const auto all = std::vector<entry>(explorer{ root }, explorer{});
+    ASSERT_EQ(all.size(), 15);
+
+    constexpr auto count = std::size_t{ 3 };
+    const auto split = [&](std::size_t depth) {
+        auto combined = std::vector<entry>{};
+        auto entries = std::size_t{};
+        for (auto index = std::size_t{ 0 }; index < count; index++) {
+            const auto options = explorer_options{
+                .shard = { .index = index, .count = count, .depth = depth },
+            };
+            auto exp = explorer{ root, options };
+            const auto part = std::vector<entry>(exp, explorer{});
+            EXPECT_LT(part.size(), all.size());
+            combined.insert(combined.end(), part.begin(), part.end());
+            entries += exp.stats().entries;
+        }
+        // Shards are disjoint, whichever depth they are split to
+        EXPECT_THAT(combined, testing::UnorderedElementsAreArray(all));
+        return entries;
+    };
+    // Each reads only its own directories, or all of those above depth
+    EXPECT_EQ(split(1), count * 9 + 12);
+    EXPECT_EQ(split(2), count * (9 + 12));
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, shard_single_directory) {
+    // Everything is below a single directory, which would go to one shard
+    auto modules = std::vector<glug::unit_test::node>{};
+    for (auto i = 0; i < 16; i++) {
+        modules.emplace_back(dir{
+                "module" + std::to_string(i),
+                { "a.c"_f, "b.c"_f, "c.h"_f, "d.h"_f },
+        });
+    }
+    const auto tree = dir{ "shard_single", { dir{ "src", modules } } };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+
+    constexpr auto count = std::size_t{ 4 };
+    auto combined = std::vector<entry>{};
+    for (auto index = std::size_t{ 0 }; index < count; index++) {
+        const auto options = explorer_options{
+            .shard = { .index = index, .count = count },
+        };
+        const auto part = std::vector<entry>(explorer{ root, options }, {});
+        EXPECT_GE(part.size(), 16 / 2);
+        EXPECT_LE(part.size(), 16 * 3 / 2);
+        combined.insert(combined.end(), part.begin(), part.end());
+    }
+    EXPECT_THAT(
+            combined,
+            testing::UnorderedElementsAreArray(
+                    std::vector<entry>(explorer{ root }, {})
+            )
+    );
+}
+
+namespace {
+
+using lister = std::function<std::vector<std::filesystem::path>(
+        const std::filesystem::path&, const explorer_options&
+)>;
+
+std::vector<std::filesystem::path>
+list_sync(const std::filesystem::path& root, const explorer_options& options) {
+    return explorer{ root, options }
+            | std::ranges::views::transform(&entry::path)
+            | backport::ranges::to<std::vector>();
+}
+
+// Consumer coroutine, running until the generator finishes
+struct detached {
+    struct promise_type {
+        detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+detached consume(
+        async_generator<entry>& generator,
+        std::vector<std::filesystem::path>& paths,
+        std::promise<void>& done
+) {
+    while (const auto entry = co_await generator.next()) {
+        paths.push_back(entry->path());
+    }
+    done.set_value();
+}
+
+detached consume_error(
+        async_generator<entry>& generator, std::exception_ptr& error
+) {
+    try {
+        // Not discarding result, GCC 12 miscompiles bare `co_await` condition
+        while (const auto entry = co_await generator.next()) {}
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+std::vector<std::filesystem::path>
+list_async(const std::filesystem::path& root, const explorer_options& options) {
+    auto pool = glug::detail::thread_pool{ 2 };
+    const auto executor = [&pool](auto task) { pool.submit(std::move(task)); };
+    auto generator = explore_async(root, options, executor);
+    auto paths = std::vector<std::filesystem::path>{};
+    auto done = std::promise<void>{};
+    consume(generator, paths, done);
+    done.get_future().wait();
+    return paths;
+}
+
+// Forwards to default resource, counting upstream allocations of explorer
+class counting_resource : public std::pmr::memory_resource {
+    public:
+    [[nodiscard]] std::size_t allocations() const noexcept {
+        return allocated.load();
+    }
+    [[nodiscard]] std::size_t outstanding() const noexcept {
+        return allocated.load() - deallocated.load();
+    }
+
+    private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        allocated++;
+        return std::pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(
+            void* pointer, std::size_t bytes, std::size_t alignment
+    ) override {
+        deallocated++;
+        std::pmr::get_default_resource()->deallocate(pointer, bytes, alignment);
+    }
+    [[nodiscard]] bool do_is_equal(
+            const std::pmr::memory_resource& other
+    ) const noexcept override {
+        return this == &other;
+    }
+
+    std::atomic<std::size_t> allocated{};
+    std::atomic<std::size_t> deallocated{};
+};
+
+void expect_listing(
+        const explorer_param& param,
+        const std::function<void(explorer_options&)>& configure,
+        bool ordered = true,
+        const lister& list = list_sync
+) {
+    const auto& [tree, expected, target, select] = param;
     const auto temp = temp_fs{};
     try {
         tree.materialize(temp);
@@ -79,19 +590,700 @@ TEST_P(explorer_test, test) {
     }
 
     const auto resolved_target = temp / target.value_or(tree.path());
-    const auto options = explorer_options{
+    auto options = explorer_options{
         filter::select{ select.value_or(""), resolved_target },
     };
+    configure(options);
     const auto relative = [&temp](const auto& entry) {
         return std::filesystem::relative(entry, temp);
     };
-    const auto actual = explorer{ resolved_target, options }
+    const auto actual = list(resolved_target, options)
+            | std::ranges::views::transform(relative)
+            | backport::ranges::to<std::vector>();
+
+    if (ordered) {
+        EXPECT_THAT(actual, testing::ElementsAreArray(expected));
+    } else {
+        EXPECT_THAT(actual, testing::UnorderedElementsAreArray(expected));
+    }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, stats) {
+    auto tree = dir{
+        "stats",
+        {
+            file{ ".gitignore", "*.log" },
+            "build.log"_f,
+            "README.md"_f,
+            "src"_d / "main.c"_f,
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    auto exp = explorer{ temp / tree.path() };
+    EXPECT_EQ(exp.stats().entries, 4);
+
+    const auto files = std::ranges::distance(exp, explorer{});
+    EXPECT_EQ(files, 3);
+    const auto stats = exp.stats();
+    EXPECT_EQ(stats.entries, 5);
+    EXPECT_EQ(stats.stats_avoided + stats.stats, stats.entries);
+    EXPECT_EQ(explorer{}.stats().entries, 0);
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, metadata) {
+    auto tree = dir{
+        "metadata",
+        {
+            file{ "a.txt", "a" },
+            file{ "b.txt", "bbb" },
+            "src"_d / file{ "main.c", "int main;" },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    auto exp = explorer{ temp / tree.path(), { .metadata = true } };
+
+    using size_pair = std::pair<std::filesystem::path, std::uintmax_t>;
+    auto sizes = std::vector<size_pair>{};
+    for (const auto& entry : exp) {
+        sizes.emplace_back(entry.path().filename(), entry.file_size());
+        EXPECT_EQ(
+                entry.last_write_time(),
+                std::filesystem::last_write_time(entry.path())
+        );
+    }
+    EXPECT_THAT(
+            sizes,
+            testing::ElementsAre(
+                    testing::Pair("a.txt", 1),
+                    testing::Pair("b.txt", 3),
+                    testing::Pair("main.c", 9)
+            )
+    );
+    EXPECT_EQ(exp.stats().stats, 3);
+
+    // Without cache, queried on demand
+    const auto plain = explorer{ temp / tree.path() };
+    EXPECT_EQ(plain->file_size(), 1);
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, metadata_bounds) {
+    auto tree = dir{
+        "metadata_bounds",
+        {
+            file{ "empty.txt" },
+            file{ "large.txt", "0123456789" },
+            file{ "old.txt", "old" },
+            file{ "small.txt", "a" },
+            "src"_d / file{ "main.c", "int main;" },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+    const auto now = std::filesystem::file_time_type::clock::now();
+    const auto old = now - std::chrono::hours{ 24 };
+    std::filesystem::last_write_time(root / "old.txt", old);
+
+    const auto list_names = [&root](const explorer_options& options) {
+        auto names = std::vector<std::string>{};
+        for (const auto& entry : explorer{ root, options }) {
+            names.push_back(entry.path().filename().string());
+            EXPECT_EQ(
+                    entry.file_size(),
+                    std::filesystem::file_size(entry.path())
+            );
+        }
+        return names;
+    };
+    EXPECT_THAT(
+            list_names({ .bounds = { .min_size = 1, .max_size = 9 } }),
+            testing::ElementsAre("old.txt", "small.txt", "main.c")
+    );
+    const auto recent = now - std::chrono::hours{ 1 };
+    EXPECT_THAT(
+            list_names({ .threads = 2, .bounds = { .min_time = recent } }),
+            testing::ElementsAre(
+                    "empty.txt", "large.txt", "small.txt", "main.c"
+            )
+    );
+    EXPECT_THAT(
+            list_names({ .unordered = true, .bounds = { .max_time = recent } }),
+            testing::ElementsAre("old.txt")
+    );
+    EXPECT_THAT(
+            list_async(root, { .bounds = { .min_size = 10 } }),
+            testing::ElementsAre(root / "large.txt")
+    );
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, memory_resource) {
+    auto tree = dir{
+        "arena",
+        {
+            "README.md"_f,
+            "docs"_d / "index.md"_f,
+            "src"_d / "a_name_too_long_for_small_string_optimization.c"_f,
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+
+    auto resource = counting_resource{};
+    for (const auto threads : { 0, 4 }) {
+        {
+            const auto options = explorer_options{
+                .threads = static_cast<std::size_t>(threads),
+                .memory_resource = &resource,
+            };
+            EXPECT_EQ(list_sync(temp / tree.path(), options).size(), 3);
+        }
+        // A single buffer for each directory, released with the explorer
+        EXPECT_EQ(resource.outstanding(), 0);
+    }
+    EXPECT_EQ(resource.allocations(), 6);
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, prune_walking_another_explorer) {
+    const auto tree = dir{
+        "outer",
+        {
+            "b.txt"_f,
+            "a.txt"_f,
+            "lib"_d / "lib.c"_f,
+            "docs"_d / "index.md"_f,
+        },
+    };
+    const auto other = dir{
+        "other",
+        { "z.txt"_f, "y.txt"_f, "x"_d / "x.c"_f, "w"_d / "w.c"_f },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    other.materialize(temp);
+    const auto root = temp / tree.path();
+    auto options = GetParam();
+    // Runs on the thread filtering the outer directory, in the middle
+    auto nested = std::make_shared<std::atomic<std::size_t>>();
+    options.prune = [&temp, &other, nested](const auto& /*path*/) {
+        *nested += list_sync(temp / other.path(), {}).size();
+        return false;
+    };
+    const auto expected = std::vector<std::filesystem::path>{
+        root / "a.txt",
+        root / "b.txt",
+        root / "docs/index.md",
+        root / "lib/lib.c",
+    };
+    expect_walk(options, list_sync(root, options), expected);
+    EXPECT_EQ(*nested, 2 * 4);
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, releases_prefetched) {
+    // Link is rejected as already walked, after workers read below it
+    const auto tree = dir{
+        "prefetched",
+        {
+            "docs"_d / ("api"_d / ("v1"_d / "index.md"_f)),
+            link{ "documentation", "docs" },
+        },
+    };
+    const auto temp = temp_fs{};
+    try {
+        tree.materialize(temp);
+    } catch (const std::filesystem::filesystem_error& e) {
+        GTEST_SKIP() << e.what();
+    }
+
+    auto resource = counting_resource{};
+    auto exp = explorer{
+        temp / tree.path(),
+        {
+            .threads = 4,
+            .follow_symlinks = true,
+            .memory_resource = &resource,
+        },
+    };
+    auto count = 0;
+    for (; exp != explorer{}; ++exp) {
+        count++;
+    }
+    EXPECT_EQ(count, 1);
+
+    // Workers may still be finishing discarded reads, but nothing is kept
+    for (auto i = 0; i < 500 && resource.outstanding() > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+    }
+    EXPECT_EQ(resource.outstanding(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, reads_linked_directories_once) {
+    const auto tree = dir{
+        "linked",
+        {
+            "docs"_d / ("api"_d / ("v1"_d / "index.md"_f)),
+            link{ "link_a", "docs" },
+            link{ "link_b", "docs" },
+            link{ "link_c", "docs" },
+            link{ "link_d", "docs" },
+        },
+    };
+    const auto temp = temp_fs{};
+    try {
+        tree.materialize(temp);
+    } catch (const std::filesystem::filesystem_error& e) {
+        GTEST_SKIP() << e.what();
+    }
+
+    auto resource = counting_resource{};
+    const auto options = explorer_options{
+        .threads = 4,
+        .follow_symlinks = true,
+        .memory_resource = &resource,
+    };
+    EXPECT_THAT(
+            list_sync(temp / tree.path(), options),
+            testing::ElementsAre(temp / tree.path() / "docs/api/v1/index.md")
+    );
+    // Workers read each directory at most once, whichever path they took,
+    // and the consumer only reads again those walked through another one
+    EXPECT_LE(resource.allocations(), 1 + (2 * 3));
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, bounds_read_ahead) {
+    // More directories than workers read ahead without lookahead
+    static constexpr auto width = 48;
+    auto outer = std::vector<glug::unit_test::node>{};
+    for (auto i = 0; i < width; i++) {
+        auto inner = std::vector<glug::unit_test::node>{};
+        for (auto j = 0; j < width; j++) {
+            inner.emplace_back(dir{ std::to_string(j), { "main.c"_f } });
+        }
+        outer.emplace_back(dir{ std::to_string(i), inner });
+    }
+    const auto tree = dir{ "wide", outer };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+
+    auto resource = counting_resource{};
+    auto exp = explorer{
+        temp / tree.path(),
+        { .threads = 4, .memory_resource = &resource },
+    };
+    // Wait for workers to stop, as they are never woken up by the consumer
+    auto allocations = std::size_t{};
+    for (auto i = 0; i < 500 && resource.allocations() != allocations; i++) {
+        allocations = resource.allocations();
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+    }
+    EXPECT_LT(resource.outstanding(), 1200);
+
+    auto count = 0;
+    for (; exp != explorer{}; ++exp) {
+        count++;
+    }
+    EXPECT_EQ(count, width * width);
+}
+
+struct recursion_param {
+    std::size_t threads{};
+    std::size_t lookahead{};
+
+    friend std::ostream&
+    operator<<(std::ostream& os, const recursion_param& param) {
+        return os << "threads_" << param.threads << "_lookahead_"
+                  << param.lookahead;
+    }
+};
+
+class disable_recursion_test
+    : public testing::TestWithParam<recursion_param> {};
+
+// NOLINTNEXTLINE
+TEST_P(disable_recursion_test, test) {
+    auto tree = dir{
+        "disable_recursion_pending",
+        {
+            "a.txt"_f,
+            "b.txt"_f,
+            "docs"_d / "index.md"_f,
+            dir{ "src", { "lib"_d / "lib.c"_f, "main.c"_f } },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+
+    // Workers may still be finishing discarded reads, but nothing is kept
+    auto resource = counting_resource{};
+    const auto settle = [&resource](std::size_t listings) {
+        for (auto i = 0; i < 500 && resource.outstanding() > listings; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+        }
+        return resource.outstanding();
+    };
+    const auto options = explorer_options{
+        .threads = GetParam().threads,
+        .lookahead = GetParam().lookahead,
+        .memory_resource = &resource,
+    };
+
+    {
+        auto exp = explorer{ root, options };
+        const auto copy = exp;
+        exp.disable_recursion_pending();
+        EXPECT_EQ(settle(1), 1);
+        EXPECT_THAT(
+                std::vector<entry>(exp, explorer{}),
+                testing::ElementsAre(root / "a.txt", root / "b.txt")
+        );
+        EXPECT_NE(exp, copy);
+        EXPECT_EQ(std::ranges::distance(copy, explorer{}), 5);
+    }
+
+    // Only pending subdirectories of the current directory are skipped
+    auto exp = std::next(explorer{ root, options }, 3);
+    ASSERT_EQ(exp->path(), root / "src/main.c");
+    exp.disable_recursion_pending();
+    EXPECT_EQ(settle(2), 2);
+    EXPECT_THAT(
+            std::vector<entry>(exp, explorer{}),
+            testing::ElementsAre(root / "src/main.c")
+    );
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        disable_recursion_test,
+        disable_recursion_test,
+        values_in<recursion_param>({
+            { .threads = 0, .lookahead = 0 },
+            { .threads = 4, .lookahead = 0 },
+            { .threads = 0, .lookahead = 2 },
+            { .threads = 4, .lookahead = 2 },
+        }),
+        [](const auto& info) { return testing::PrintToString(info.param); }
+);
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, sorts_wide_directory) {
+    // Enough names sharing prefixes to be sorted by partitioning them
+    auto names = std::vector<std::string>{};
+    for (const auto* prefix : { "a", "ab", "abc", "B", "_", "a.b", "~" }) {
+        for (const auto* suffix : { "", "1", "10", "2", "a", "A" }) {
+            names.push_back(std::string{ prefix } + suffix);
+        }
+    }
+    auto contents = std::vector<glug::unit_test::node>{};
+    for (const auto& name : names) {
+        contents.emplace_back(file{ name });
+        contents.emplace_back(dir{ "d" + name } / "f"_f);
+    }
+    const auto tree = dir{ "wide", contents };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+
+    const auto root = temp / tree.path();
+    std::ranges::sort(names);
+    auto expected = std::vector<std::filesystem::path>{};
+    for (const auto& name : names) {
+        expected.push_back(root / name);
+    }
+    for (const auto& name : names) {
+        expected.push_back(root / ("d" + name) / "f");
+    }
+    EXPECT_THAT(list_sync(root, {}), testing::ElementsAreArray(expected));
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, follow_symlinks) {
+    const auto external = "external"_d / "lib.c"_f;
+    const auto tree = dir{
+        "follow",
+        {
+            "docs"_d / "README.md"_f,
+            link{ "documentation", "docs" },
+            link{ "README.md", "docs/README.md" },
+            "loop"_d / link{ "back", ".." },
+            link{ "vendor", "../external" },
+            link{ "dangling", "missing" },
+        },
+    };
+    const auto temp = temp_fs{};
+    try {
+        external.materialize(temp);
+        tree.materialize(temp);
+    } catch (const std::filesystem::filesystem_error& e) {
+        GTEST_SKIP() << e.what();
+    }
+
+    const auto expected = std::vector<std::filesystem::path>{
+        "follow/README.md",
+        "follow/docs/README.md",
+        "follow/vendor/lib.c",
+    };
+    // Unlike `std::filesystem::relative`, does not resolve symlinks
+    const auto relative = [&temp](const auto& path) {
+        return path.lexically_relative(temp.path());
+    };
+    auto options = GetParam();
+    options.follow_symlinks = true;
+    const auto actual = list_sync(temp / tree.path(), options)
             | std::ranges::views::transform(relative)
             | backport::ranges::to<std::vector>();
+    if (options.unordered) {
+        // Either of the paths to docs may come first
+        EXPECT_EQ(actual.size(), expected.size());
+        EXPECT_THAT(actual, testing::Contains(expected.back()));
+    } else {
+        EXPECT_THAT(actual, testing::ElementsAreArray(expected));
+    }
+
+    // Walked in order regardless of mode, which is ignored
+    const auto awaited = list_async(temp / tree.path(), options)
+            | std::ranges::views::transform(relative)
+            | backport::ranges::to<std::vector>();
+    EXPECT_THAT(awaited, testing::ElementsAreArray(expected));
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, nested_repositories) {
+    const auto param = explorer_param{
+        dir{
+            "nested",
+            {
+                ".git"_d,
+                file{ ".gitignore", "*.log\nvendor/ignored/\n" },
+                "README.md"_f,
+                "app.log"_f,
+                dir{
+                    "submodule",
+                    {
+                        file{ ".git", "gitdir: ../.git/modules/submodule" },
+                        "mod.c"_f,
+                    },
+                },
+                dir{
+                    "vendor",
+                    {
+                        dir{ "ignored", { ".git"_d, "skipped.c"_f } },
+                        dir{
+                            "lib",
+                            {
+                                ".git"_d,
+                                file{ ".gitignore", "*.tmp" },
+                                "cache.tmp"_f,
+                                "debug.log"_f,
+                                "lib.c"_f,
+                                dir{ "sub", { ".git"_d, "sub.c"_f } },
+                            },
+                        },
+                    },
+                },
+            },
+        },
+        {
+            "nested/.gitignore",
+            "nested/README.md",
+            "nested/submodule/mod.c",
+            "nested/vendor/lib/.gitignore",
+            "nested/vendor/lib/debug.log",
+            "nested/vendor/lib/lib.c",
+            "nested/vendor/lib/sub/sub.c",
+        },
+    };
+    const auto nested = [](auto& options) {
+        options.nested_repositories = true;
+    };
+    expect_listing(param, nested);
+    expect_listing(param, nested, true, list_async);
+    expect_listing(param, [&nested](auto& options) {
+        nested(options);
+        options.threads = 4;
+    });
+    expect_listing(param, [&nested](auto& options) {
+        nested(options);
+        options.lookahead = 1;
+        options.threads = 2;
+    });
+    const auto unordered = [&nested](auto& options) {
+        nested(options);
+        options.unordered = true;
+    };
+    expect_listing(param, unordered, false);
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_test, test) {
+    expect_listing(GetParam(), [](auto&) {});
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_test, parallel) {
+    expect_listing(GetParam(), [](auto& options) { options.threads = 4; });
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_test, lookahead) {
+    expect_listing(GetParam(), [](auto& options) { options.lookahead = 2; });
+}
+
+// NOLINTNEXTLINE
+TEST_F(explorer_test, async_throws) {
+    const auto temp = temp_fs{};
+    const auto inline_executor = [](auto task) { task(); };
+    auto generator
+            = explore_async(temp.path() / "missing", {}, inline_executor);
+    auto error = std::exception_ptr{};
+    consume_error(generator, error);
+    EXPECT_THROW(
+            std::rethrow_exception(error), std::filesystem::filesystem_error
+    );
+    EXPECT_FALSE(generator.next().await_resume());
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_test, async) {
+    expect_listing(GetParam(), [](auto&) {}, true, list_async);
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_test, unordered) {
+    const auto configure = [](auto& options) { options.unordered = true; };
+    expect_listing(GetParam(), configure, false);
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_test, memory) {
+    const auto& [tree, expected, target, select] = GetParam();
+    const auto temp = temp_fs{};
+    try {
+        tree.materialize(temp);
+    } catch (const std::filesystem::filesystem_error& e) {
+        GTEST_SKIP() << e.what();
+    }
 
+    // Same walk, but of a copy whose root is "/" instead of `temp`
+    const auto root = std::filesystem::path{ "/" };
+    const auto resolved_target = root / target.value_or(tree.path());
+    auto options = explorer_options{
+        filter::select{ select.value_or(""), resolved_target },
+    };
+    options.source = std::make_shared<const glug::filesystem::memory_tree>(
+            glug::filesystem::memory_tree::record(temp)
+    );
+    const auto relative = [&root](const auto& entry) {
+        return entry.lexically_relative(root);
+    };
+    const auto actual = list_sync(resolved_target, options)
+            | std::ranges::views::transform(relative)
+            | backport::ranges::to<std::vector>();
     EXPECT_THAT(actual, testing::ElementsAreArray(expected));
 }
 
+namespace {
+
+// Sparse checkout of `lib/core` and `docs`, leaving out other directories
+auto make_sparse_info() {
+    return dir{
+        "info",
+        {
+            file{
+                "sparse-checkout",
+                "/*\n!/*/\n/docs/\n/lib/\n!/lib/*/\n/lib/core/\n",
+            },
+        },
+    };
+}
+
+// Config as written by `git sparse-checkout set --cone`, in `config.worktree`
+// enabled from `config`
+auto make_sparse_git(std::string_view cone = "true") {
+    return dir{
+        ".git",
+        {
+            file{ "config", "[extensions]\n\tworktreeConfig = true\n" },
+            file{
+                "config.worktree",
+                "[core]\n\tsparseCheckout = true\n\tsparseCheckoutCone = "
+                        + std::string{ cone } + "\n",
+            },
+            make_sparse_info(),
+        },
+    };
+}
+
+auto make_sparse_tree(
+        std::string_view root_name,
+        const glug::unit_test::node& git = make_sparse_git()
+) {
+    return dir{
+        root_name,
+        {
+            git,
+            file{ "README.md" },
+            "build"_d / "out.o"_f,
+            dir{ "docs", { "guide.md"_f, "img"_d / "logo.png"_f } },
+            dir{
+                "lib",
+                {
+                    "util.c"_f,
+                    dir{ "core", { "main.c"_f, "sub"_d / "impl.c"_f } },
+                    "extra"_d / "plugin.c"_f,
+                },
+            },
+        },
+    };
+}
+
+// Linked worktree, whose `.git` file points to its git directory, sharing
+// config with the main repository through `commondir`
+auto make_sparse_worktree(std::string_view root_name) {
+    return dir{
+        root_name,
+        {
+            dir{
+                "main.git",
+                {
+                    file{
+                        "config",
+                        "[core]\n\tbare = true\n"
+                        "[extensions]\n\tworktreeConfig = true\n",
+                    },
+                    "worktrees"_d
+                            / dir{
+                                "repo",
+                                {
+                                    file{ "commondir", "../..\n" },
+                                    file{
+                                        "config.worktree",
+                                        "[core]\n\tsparseCheckout = true\n"
+                                        "\tsparseCheckoutCone = true\n",
+                                    },
+                                    make_sparse_info(),
+                                },
+                            },
+                },
+            },
+            make_sparse_tree(
+                    "repo", file{ ".git", "gitdir: ../main.git/worktrees/repo\n" }
+            ),
+        },
+    };
+}
+
+}  // namespace
+
 static const auto explorer_cases = std::vector<explorer_param>{
     {
         { "simple"_d / "README.md"_f },
@@ -469,6 +1661,84 @@ static const auto explorer_cases = std::vector<explorer_param>{
         },
         "submodule_target_middle/submodules",
     },
+    {
+        make_sparse_tree("sparse_checkout"),
+        {
+            "sparse_checkout/README.md",
+            "sparse_checkout/docs/guide.md",
+            "sparse_checkout/docs/img/logo.png",
+            "sparse_checkout/lib/util.c",
+            "sparse_checkout/lib/core/main.c",
+            "sparse_checkout/lib/core/sub/impl.c",
+        },
+    },
+    {
+        make_sparse_tree("sparse_checkout_target_middle"),
+        {
+            "sparse_checkout_target_middle/lib/util.c",
+            "sparse_checkout_target_middle/lib/core/main.c",
+            "sparse_checkout_target_middle/lib/core/sub/impl.c",
+        },
+        "sparse_checkout_target_middle/lib",
+    },
+    {
+        make_sparse_tree("sparse_checkout_target_outside"),
+        {
+            "sparse_checkout_target_outside/build/out.o",
+        },
+        "sparse_checkout_target_outside/build",
+    },
+    {
+        // Flags set in `config` itself, as by older versions of git
+        make_sparse_tree(
+                "sparse_checkout_config",
+                dir{
+                    ".git",
+                    {
+                        file{
+                            "config",
+                            "[core]\n\tsparseCheckout = true\n"
+                            "\tsparseCheckoutCone = true\n",
+                        },
+                        make_sparse_info(),
+                    },
+                }
+        ),
+        {
+            "sparse_checkout_config/README.md",
+            "sparse_checkout_config/docs/guide.md",
+            "sparse_checkout_config/docs/img/logo.png",
+            "sparse_checkout_config/lib/util.c",
+            "sparse_checkout_config/lib/core/main.c",
+            "sparse_checkout_config/lib/core/sub/impl.c",
+        },
+    },
+    {
+        // Patterns are not a cone, so everything is walked
+        make_sparse_tree("sparse_checkout_not_cone", make_sparse_git("false")),
+        {
+            "sparse_checkout_not_cone/README.md",
+            "sparse_checkout_not_cone/build/out.o",
+            "sparse_checkout_not_cone/docs/guide.md",
+            "sparse_checkout_not_cone/docs/img/logo.png",
+            "sparse_checkout_not_cone/lib/util.c",
+            "sparse_checkout_not_cone/lib/core/main.c",
+            "sparse_checkout_not_cone/lib/core/sub/impl.c",
+            "sparse_checkout_not_cone/lib/extra/plugin.c",
+        },
+    },
+    {
+        make_sparse_worktree("sparse_checkout_worktree"),
+        {
+            "sparse_checkout_worktree/repo/README.md",
+            "sparse_checkout_worktree/repo/docs/guide.md",
+            "sparse_checkout_worktree/repo/docs/img/logo.png",
+            "sparse_checkout_worktree/repo/lib/util.c",
+            "sparse_checkout_worktree/repo/lib/core/main.c",
+            "sparse_checkout_worktree/repo/lib/core/sub/impl.c",
+        },
+        "sparse_checkout_worktree/repo",
+    },
 };
 
 // NOLINTNEXTLINE
@@ -555,6 +1825,24 @@ const auto select_cases = std::vector<explorer_param>({
         std::nullopt,
         "test/**",
     },
+    {
+        make_select_case_tree("select_anchored_recursive"),
+        {
+            "select_anchored_recursive/include/foo.hpp",
+            "select_anchored_recursive/include/detail/impl.hpp",
+        },
+        std::nullopt,
+        "include/**/*.hpp",
+    },
+    {
+        make_select_case_tree("select_anchored_many"),
+        {
+            "select_anchored_many/src/foo.cpp",
+            "select_anchored_many/test/data/curl.py",
+        },
+        std::nullopt,
+        "test/data/*.py,src/*.cpp,-main.*",
+    },
 });
 
 // NOLINTNEXTLINE
@@ -565,5 +1853,96 @@ INSTANTIATE_TEST_SUITE_P(
         [](const auto& info) { return info.param.tree.name().string(); }
 );
 
+// NOLINTNEXTLINE
+TEST_F(explorer_test, select_narrowing) {
+    const auto tree = make_select_case_tree("select_narrowing");
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+
+    auto exp = explorer{ root, { filter::select{ "test/data/*.py", root } } };
+    EXPECT_THAT(
+            std::vector<entry>(exp, explorer{}),
+            testing::ElementsAre(root / "test/data/curl.py")
+    );
+    // Only root .gitignore, test, data and curl.py are ever read
+    EXPECT_EQ(exp.stats().entries, 4);
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, multiple_roots) {
+    const auto tree = make_select_case_tree("multiple_roots");
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+    const auto roots = std::vector<std::filesystem::path>{
+        root / "src",
+        root / "test",
+        root / "test/data",
+        root / "include",
+        root / "src",
+    };
+
+    // Rules above roots apply to each. Nested roots are walked on their own,
+    // only repeated ones are dropped.
+    const auto expected = std::vector<std::filesystem::path>{
+        root / "src/foo.cpp",
+        root / "src/main.cpp",
+        root / "test/run.py",
+        root / "test/data/curl.py",
+        root / "include/foo.hpp",
+        root / "include/detail/impl.hpp",
+    };
+    const auto& options = GetParam();
+    const auto paths = explorer{ roots, options }
+            | std::ranges::views::transform(&entry::path)
+            | backport::ranges::to<std::vector>();
+    expect_walk(options, paths, expected);
+    EXPECT_EQ(
+            (explorer{ std::vector<std::filesystem::path>{}, options }),
+            explorer{}
+    );
+}
+
+// NOLINTNEXTLINE
+TEST_P(explorer_mode_test, nested_roots) {
+    const auto tree = dir{
+        "nested_roots",
+        {
+            ".git"_d,
+            file{ ".gitignore", "build/\n" },
+            "main.c"_f,
+            "build"_d / "out.o"_f,
+            dir{ "sub", { ".git"_d, "s.c"_f } },
+        },
+    };
+    const auto temp = temp_fs{};
+    tree.materialize(temp);
+    const auto root = temp / tree.path();
+
+    // Walk of outer root never gets to ignored directory and nested
+    // repository, so they are walked only as roots of their own
+    const auto expected = std::vector<std::filesystem::path>{
+        root / ".gitignore",
+        root / "main.c",
+        root / "build/out.o",
+        root / "sub/s.c",
+    };
+    const auto roots = std::vector<std::filesystem::path>{
+        root,
+        root / "build",
+        root / "sub",
+    };
+    // Same whether the outer walk is allowed into nested repositories or not
+    for (const auto nested : { false, true }) {
+        auto options = GetParam();
+        options.nested_repositories = nested;
+        const auto paths = explorer{ roots, options }
+                | std::ranges::views::transform(&entry::path)
+                | backport::ranges::to<std::vector>();
+        expect_walk(options, paths, expected);
+    }
+}
+
 }  // namespace glug::filesystem::unit_test
 
@@ -0,0 +1,148 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/filesystem/memory.hpp"
+
+#include "glug/filesystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace glug::filesystem::unit_test {
+
+using std::filesystem::file_type;
+using path_char = std::filesystem::path::value_type;
+
+namespace {
+
+auto read_all(directory_reader& reader) {
+    auto result = std::vector<std::pair<std::filesystem::path, file_type>>{};
+    while (const auto raw = reader.next()) {
+        result.emplace_back(raw->name, raw->type);
+    }
+    return result;
+}
+
+constexpr auto listing = R"(.gitignore
+	*.log
+	/build/
+src/
+src/lib/
+src/lib/util.cpp
+src/link@
+src/main.cpp
+)";
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(memory_tree_test, parses_and_lists) {
+    const auto tree = memory_tree::parse(listing);
+    EXPECT_EQ(tree.listing(), listing);
+
+    auto reader = tree.open("src");
+    EXPECT_THAT(
+            read_all(reader),
+            testing::ElementsAre(
+                    testing::Pair("lib", file_type::directory),
+                    testing::Pair("link", file_type::symlink),
+                    testing::Pair("main.cpp", file_type::regular)
+            )
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(memory_tree_test, adds_entries) {
+    auto tree = memory_tree{};
+    tree.add_file("a/b/c.txt", "text");
+    tree.add_directory("a/d/");
+    tree.add_directory("a");
+    tree.add_symlink("e");
+    EXPECT_EQ(tree.listing(), "a/\na/b/\na/b/c.txt\n\ttext\na/d/\ne@\n");
+
+    // Replacing directory drops its contents
+    tree.add_file("a/b");
+    EXPECT_EQ(tree.listing(), "a/\na/b\na/d/\ne@\n");
+}
+
+// NOLINTNEXTLINE
+TEST(memory_tree_test, resolves_paths) {
+    const auto tree = memory_tree::parse(listing);
+    EXPECT_EQ(tree.canonical("."), "/");
+    EXPECT_EQ(tree.canonical("/src/lib/"), "/src/lib");
+    EXPECT_EQ(tree.canonical("src/../src/./main.cpp"), "/src/main.cpp");
+    EXPECT_THROW(
+            std::ignore = tree.canonical("missing"),
+            std::filesystem::filesystem_error
+    );
+    EXPECT_THROW(
+            std::ignore = tree.open("src/main.cpp"),
+            std::filesystem::filesystem_error
+    );
+}
+
+// NOLINTNEXTLINE
+TEST(memory_tree_test, reads_like_directory) {
+    const auto tree = memory_tree::parse(listing);
+    const auto root = tree.open("/");
+    EXPECT_EQ(root.type(".gitignore"), file_type::regular);
+    EXPECT_EQ(root.type("missing"), file_type::not_found);
+    EXPECT_EQ(root.read(".gitignore"), "*.log\n/build/\n");
+    EXPECT_EQ(root.read("src"), "");
+
+    const auto src = directory_reader{ root, "src" };
+    EXPECT_NE(src.id(), root.id());
+    EXPECT_EQ(src.id(), tree.open("src").id());
+    EXPECT_THROW(
+            (directory_reader{ src, "link", true }),
+            std::filesystem::filesystem_error
+    );
+
+    const auto names = std::to_array<const path_char*>({ "main.cpp", "link" });
+    const auto status = src.status(names, false);
+    ASSERT_EQ(status.size(), 2);
+    EXPECT_EQ(status[0].type, file_type::regular);
+    EXPECT_EQ(status[1].type, file_type::symlink);
+    EXPECT_EQ(src.status(names, true)[1].type, file_type::not_found);
+}
+
+// NOLINTNEXTLINE
+TEST(memory_tree_test, outlives_copies) {
+    auto reader = directory_reader{};
+    {
+        const auto tree = memory_tree::parse(listing);
+        reader = directory_reader{ tree.open("/"), "src" };
+    }
+    EXPECT_THAT(read_all(reader), testing::SizeIs(3));
+}
+
+// NOLINTNEXTLINE
+TEST(memory_tree_test, explored) {
+    auto options = explorer_options{};
+    options.source = std::make_shared<const memory_tree>(
+            memory_tree::parse(listing + std::string{ ".git/\nbuild/x.o\n" })
+    );
+    auto explorer = glug::filesystem::explorer{ "/", options };
+    auto paths = std::vector<std::string>{};
+    std::ranges::transform(
+            explorer,
+            std::back_inserter(paths),
+            [](const auto& entry) { return entry.path().generic_string(); }
+    );
+    EXPECT_THAT(
+            paths,
+            testing::ElementsAre(
+                    "/.gitignore", "/src/main.cpp", "/src/lib/util.cpp"
+            )
+    );
+}
+
+}  // namespace glug::filesystem::unit_test
@@ -0,0 +1,58 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/filter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace glug::filter::unit_test {
+
+// NOLINTNEXTLINE
+TEST(cone_test, parses_cone_patterns) {
+    const auto cone = cone::parse(
+            "# comment\r\n/*\r\n!/*/\r\n/docs/\r\n/lib/\r\n!/lib/*/\r\n"
+            "/lib/core/\r\n/lib/my\\*dir/\r\n"
+    );
+    ASSERT_TRUE(cone);
+    EXPECT_FALSE(cone->is_recursive());
+    EXPECT_EQ(cone->subdirectory("build"), nullptr);
+
+    const auto* docs = cone->subdirectory("docs");
+    ASSERT_NE(docs, nullptr);
+    EXPECT_TRUE(docs->is_recursive());
+    EXPECT_EQ(docs->subdirectory("any"), docs);
+
+    const auto* lib = cone->subdirectory("lib");
+    ASSERT_NE(lib, nullptr);
+    EXPECT_FALSE(lib->is_recursive());
+    EXPECT_EQ(lib->subdirectory("extra"), nullptr);
+    ASSERT_NE(lib->subdirectory("core"), nullptr);
+    EXPECT_TRUE(lib->subdirectory("core")->is_recursive());
+    EXPECT_NE(lib->subdirectory("my*dir"), nullptr);
+}
+
+// NOLINTNEXTLINE
+TEST(cone_test, implies_parents) {
+    const auto cone = cone::parse("/*\n!/*/\n/a/b/\n");
+    ASSERT_TRUE(cone);
+    const auto* a = cone->subdirectory("a");
+    ASSERT_NE(a, nullptr);
+    EXPECT_FALSE(a->is_recursive());
+    EXPECT_EQ(a->subdirectory("c"), nullptr);
+    ASSERT_NE(a->subdirectory("b"), nullptr);
+    EXPECT_TRUE(a->subdirectory("b")->is_recursive());
+}
+
+// NOLINTNEXTLINE
+TEST(cone_test, full_checkout_is_recursive) {
+    EXPECT_TRUE(cone::parse("")->is_recursive());
+    EXPECT_TRUE(cone::parse("/*\n")->is_recursive());
+}
+
+// NOLINTNEXTLINE
+TEST(cone_test, rejects_other_patterns) {
+    EXPECT_FALSE(cone::parse("/*\n!/*/\n*.log\n"));
+    EXPECT_FALSE(cone::parse("/*\n!/*/\n/src/*.cpp/\n"));
+    EXPECT_FALSE(cone::parse("/*\n!/*/\n/src\n"));
+    EXPECT_FALSE(cone::parse("/*\n!/*/\n//\n"));
+}
+
+}  // namespace glug::filter::unit_test
@@ -147,6 +147,23 @@ static const auto ignore_cases = std::vector<ignore_param>{
 // NOLINTNEXTLINE
 INSTANTIATE_TEST_SUITE_P(test, ignore_test, testing::ValuesIn(ignore_cases));
 
+// NOLINTNEXTLINE
+TEST(ignore_merge, nested_first) {
+    const auto parent_globs = std::vector<std::string_view>{ "*.log", "/tmp" };
+    const auto nested_globs = std::vector<std::string_view>{ "!keep.log" };
+    const auto parent = filter::ignore{ parent_globs, "root" };
+    const auto nested = filter::ignore{ nested_globs, "root/src" };
+    const auto merged = filter::ignore{ parent, nested };
+
+    EXPECT_TRUE(filter::ignore{}.empty());
+    EXPECT_FALSE(merged.empty());
+    EXPECT_EQ(merged.apply("root/src/build.log", false), decision::excluded);
+    EXPECT_EQ(merged.apply("root/src/keep.log", false), decision::included);
+    EXPECT_EQ(merged.apply("root/tmp", true), decision::excluded);
+    EXPECT_EQ(merged.apply("root/src/tmp", true), decision::undecided);
+    EXPECT_EQ(merged.apply("root/src/main.c", false), decision::undecided);
+}
+
 // NOLINTNEXTLINE
 TEST(decision, to_string) {
     static constexpr auto str
@@ -4,6 +4,7 @@
 #include "tree.hpp"
 
 #include <filesystem>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -127,5 +128,39 @@ static const auto select_cases = std::vector<select_param>{
 // NOLINTNEXTLINE
 INSTANTIATE_TEST_SUITE_P(test, select_test, testing::ValuesIn(select_cases));
 
+// NOLINTNEXTLINE
+TEST(select_scope, anchored) {
+    const auto filter = filter::select{ "src/net/**/*.cpp,src/*/test/*", "/r" };
+    EXPECT_TRUE(filter.may_contain(""));
+    EXPECT_TRUE(filter.may_contain("/r"));
+    EXPECT_TRUE(filter.may_contain("/r/src"));
+    EXPECT_TRUE(filter.may_contain("/r/src/net/a/b"));
+    EXPECT_TRUE(filter.may_contain("/r/src/io/test"));
+    EXPECT_FALSE(filter.may_contain("/r/docs"));
+    EXPECT_FALSE(filter.may_contain("/r/src/io/test/data"));
+    EXPECT_FALSE(filter.may_contain("/other"));
+
+    using names = std::vector<std::string>;
+    EXPECT_EQ(filter.subdirectories("/r"), names{ "src" });
+    EXPECT_EQ(filter.subdirectories("/r/src"), std::nullopt);
+    EXPECT_EQ(filter.subdirectories("/r/src/io"), names{ "test" });
+    EXPECT_EQ(filter.subdirectories("/r/src/io/test"), std::nullopt);
+    EXPECT_EQ(filter.subdirectories("/r/docs"), names{});
+}
+
+// NOLINTNEXTLINE
+TEST(select_scope, unscoped) {
+    // Unanchored globs, or only negative ones, may select files anywhere
+    for (const auto* const globs : { "src/*.cpp,*.hpp", "-*.md", "test/" }) {
+        const auto filter = filter::select{ globs, "/r" };
+        EXPECT_TRUE(filter.may_contain("/r/docs")) << globs;
+        EXPECT_EQ(filter.subdirectories("/r"), std::nullopt) << globs;
+    }
+
+    // Negative globs do not widen the scope
+    const auto filter = filter::select{ "docs/*.md,-*.txt", "/r" };
+    EXPECT_FALSE(filter.may_contain("/r/src"));
+}
+
 }  // namespace glug::filter::unit_test
 
@@ -0,0 +1,65 @@
+// Provided as part of glug under MIT license, (c) 2026 Dominik Kaszewski
+#include "glug/filter.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace glug::filter::unit_test {
+
+namespace {
+
+auto match_names(const typetags& tags, std::string_view name) {
+    auto indices = std::vector<std::size_t>{ 42 };
+    tags.match(name, indices);
+    auto result = std::vector<std::string>{};
+    for (const auto index : indices) {
+        result.push_back(tags.names().at(index));
+    }
+    return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(typetags_test, matches_names) {
+    const auto tags = typetags{ {
+            { "cpp", "*.cpp,*.hpp,*.h" },
+            { "cc", "*.c,*.h" },
+            { "asm", "*.asm,*.[sS]" },
+            { "make", "*.mk,[mM]akefile,GNUmakefile" },
+            { "archive", "*.tar.gz" },
+    } };
+    EXPECT_THAT(
+            tags.names(),
+            testing::ElementsAre("archive", "asm", "cc", "cpp", "make")
+    );
+
+    EXPECT_THAT(match_names(tags, "main.cpp"), testing::ElementsAre("cpp"));
+    EXPECT_THAT(
+            match_names(tags, "main.h"), testing::ElementsAre("cc", "cpp")
+    );
+    EXPECT_THAT(match_names(tags, "boot.S"), testing::ElementsAre("asm"));
+    EXPECT_THAT(match_names(tags, "makefile"), testing::ElementsAre("make"));
+    EXPECT_THAT(
+            match_names(tags, "GNUmakefile"), testing::ElementsAre("make")
+    );
+    EXPECT_THAT(
+            match_names(tags, "src.tar.gz"), testing::ElementsAre("archive")
+    );
+    EXPECT_THAT(match_names(tags, "README"), testing::IsEmpty());
+    EXPECT_THAT(match_names(tags, "main.cpp.in"), testing::IsEmpty());
+}
+
+// NOLINTNEXTLINE
+TEST(typetags_test, empty) {
+    const auto tags = typetags{};
+    EXPECT_THAT(tags.names(), testing::IsEmpty());
+    EXPECT_THAT(match_names(tags, "main.cpp"), testing::IsEmpty());
+}
+
+}  // namespace glug::filter::unit_test
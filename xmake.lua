@@ -130,6 +130,16 @@ target('unit_test')
     after_build(copy_latest)
 target_end()
 
+-- Not built by default, see README
+target('benchmark')
+    set_kind('binary')
+    set_default(false)
+    add_files('src/**.cpp|main.cpp', 'test/benchmark/**.cpp')
+    add_includedirs('include')
+    add_packages(get_config('regex'))
+    add_options('regex', 'tag')
+target_end()
+
 target('parity_test')
     set_kind('phony')
     add_tests('default')